@@ -0,0 +1,121 @@
+//
+//  HexColor.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HexColor.h"
+
+static const char hexDigits[16] = "0123456789ABCDEF";
+
+static inline bool isAsciiSpace(uint32_t c) {
+    return (c >= 0x09 && c <= 0x0D) || c == 0x20;
+}
+
+// The same characters as NSCharacterSet.whitespaceAndNewlineCharacterSet
+static inline bool isSpace(uint32_t c) {
+    return isAsciiSpace(c) || c == 0x85 || c == 0xA0 || c == 0x1680 ||
+           (c >= 0x2000 && c <= 0x200A) || c == 0x2028 || c == 0x2029 || c == 0x202F ||
+           c == 0x205F || c == 0x3000;
+}
+
+static inline int hexValue(uint32_t c) {
+    if (c >= '0' && c <= '9') {
+        return (int)(c - '0');
+    }
+
+    c |= 0x20; // Lower case
+
+    if (c >= 'a' && c <= 'f') {
+        return (int)(c - 'a' + 10);
+    }
+
+    return -1;
+}
+
+static inline uint32_t utf8Unit(const void *str, size_t i) {
+    return ((const uint8_t *)str)[i];
+}
+
+static inline uint32_t utf16Unit(const void *str, size_t i) {
+    return ((const uint16_t *)str)[i];
+}
+
+// The UTF-8 and UTF-16 parsers only differ in the code unit type and what
+// counts as whitespace. Anything that is not ASCII can only be whitespace, so
+// there is no need to decode UTF-8 sequences. The reader and the predicate are
+// constants in each caller, so they are inlined.
+static inline bool parseHexColor(const void *str,
+                                 size_t len,
+                                 uint32_t (*unit)(const void *str, size_t i),
+                                 bool (*space)(uint32_t c),
+                                 uint32_t *rgba) {
+    size_t start = 0;
+    size_t end = len;
+
+    while (start < end && space(unit(str, start))) {
+        start++;
+    }
+
+    while (end > start && space(unit(str, end - 1))) {
+        end--;
+    }
+
+    if (start < end && unit(str, start) == '#') {
+        start++;
+    }
+
+    size_t digits = end - start;
+
+    if (digits != 6 && digits != 8) {
+        return false;
+    }
+
+    uint32_t value = 0;
+
+    for (size_t i = start; i < end; i++) {
+        int v = hexValue(unit(str, i));
+
+        if (v < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)v;
+    }
+
+    *rgba = (digits == 6) ? HEX_COLOR_OPAQUE(value) : value;
+    return true;
+}
+
+bool HexColorParseUTF8(const char *str, size_t len, uint32_t *rgba) {
+    // Only single byte whitespace is skipped in UTF-8
+    return parseHexColor(str, len, utf8Unit, isAsciiSpace, rgba);
+}
+
+bool HexColorParseUTF16(const uint16_t *str, size_t len, uint32_t *rgba) {
+    return parseHexColor(str, len, utf16Unit, isSpace, rgba);
+}
+
+size_t HexColorFormat(uint32_t rgba, char *out) {
+    out[0] = '#';
+
+    for (int i = 0; i < 8; i++) {
+        out[8 - i] = hexDigits[(rgba >> (i * 4)) & 0x0F];
+    }
+
+    out[9] = 0;
+    return 9;
+}
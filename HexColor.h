@@ -0,0 +1,55 @@
+//
+//  HexColor.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plain C parsing and formatting of HTML hex colors, used by UIColor+HTML.
+// Colors are packed as 0xRRGGBBAA. Nothing here allocates.
+
+#ifndef HexColor_h
+#define HexColor_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// "#RRGGBBAA" plus the terminating zero
+#define HEX_COLOR_MAX_CHARS 10
+
+#define HEX_COLOR_RGBA(RGB, A) ((((uint32_t)(RGB)) << 8) | ((uint32_t)(A) & 0xFF))
+#define HEX_COLOR_OPAQUE(RGB) HEX_COLOR_RGBA((RGB), 0xFF)
+
+// Parses "RRGGBB" or "RRGGBBAA", with an optional leading '#', in either case.
+// Leading and trailing whitespace is skipped. Colors without alpha are opaque.
+// Returns false if the string is not a valid color.
+bool HexColorParseUTF8(const char *str, size_t len, uint32_t *rgba);
+bool HexColorParseUTF16(const uint16_t *str, size_t len, uint32_t *rgba);
+
+// Writes "#RRGGBBAA" and a terminating zero into out, which must have room for
+// HEX_COLOR_MAX_CHARS. Returns the number of characters, not including the zero.
+size_t HexColorFormat(uint32_t rgba, char *out);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !HexColor_h
@@ -0,0 +1,282 @@
+//
+//  MarkupEstimate.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MarkupEstimate.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define CACHED_FONTS 16
+
+// Advances are cached for the whole BMP in pages of 256, made when first used
+#define PAGE_SHIFT 8
+#define PAGE_CHARS (1 << PAGE_SHIFT)
+#define PAGES (0x10000 >> PAGE_SHIFT)
+
+// NSParagraphStyle.defaultParagraphStyle has a tab stop every 28 points
+#define DEFAULT_TAB_INTERVAL 28.0
+
+typedef struct {
+    MarkupFontKey key;
+    double lineHeight;
+    double attachmentWidth;
+    float *pages[PAGES]; // Each advance is negative until measured
+    bool used;
+} CachedFont;
+
+struct MarkupMetricsCache {
+    MarkupMetrics metrics;
+    CachedFont fonts[CACHED_FONTS];
+    size_t next;
+};
+
+typedef struct {
+    double width;
+    double height;     // Of the finished lines
+    double x;          // Where the next character goes
+    double lineStart;  // Where the current line started
+    double lineHeight; // Tallest font on the current line
+    double word;       // Width since the last place the line could break
+    double headIndent; // Where wrapped lines start in this paragraph
+    const MarkupState *paragraph;
+    bool lineHasContent;
+} Layout;
+
+MarkupMetricsCache *MarkupMetricsCacheCreate(const MarkupMetrics *metrics) {
+    MarkupMetricsCache *cache = calloc(1, sizeof(MarkupMetricsCache));
+
+    if (cache != NULL) {
+        cache->metrics = *metrics;
+    }
+
+    return cache;
+}
+
+static void freePages(CachedFont *font) {
+    for (size_t i = 0; i < PAGES; i++) {
+        free(font->pages[i]);
+        font->pages[i] = NULL;
+    }
+}
+
+void MarkupMetricsCacheFree(MarkupMetricsCache *cache) {
+    if (cache != NULL) {
+        for (size_t i = 0; i < CACHED_FONTS; i++) {
+            freePages(&cache->fonts[i]);
+        }
+    }
+    free(cache);
+}
+
+static inline bool sameFont(const MarkupFontKey *a, const MarkupFontKey *b) {
+    return a->pointSize == b->pointSize && a->bold == b->bold && a->italic == b->italic &&
+           a->fixed == b->fixed;
+}
+
+static CachedFont *cachedFont(MarkupMetricsCache *cache, const MarkupState *state) {
+    MarkupFontKey key = {state->pointSize, state->bold, state->italic, state->fixed};
+
+    for (size_t i = 0; i < CACHED_FONTS; i++) {
+        CachedFont *font = &cache->fonts[i];
+
+        if (font->used && sameFont(&font->key, &key)) {
+            return font;
+        }
+    }
+
+    // Replace the oldest
+    CachedFont *font = &cache->fonts[cache->next];
+    cache->next = (cache->next + 1) % CACHED_FONTS;
+
+    font->key = key;
+    font->used = true;
+    font->lineHeight = cache->metrics.lineHeight(cache->metrics.context, key);
+    font->attachmentWidth = cache->metrics.attachmentWidth(cache->metrics.context, key);
+    freePages(font);
+
+    return font;
+}
+
+static float *makePage(CachedFont *font, uint16_t c) {
+    float *page = malloc(PAGE_CHARS * sizeof(float));
+
+    if (page != NULL) {
+        for (size_t i = 0; i < PAGE_CHARS; i++) {
+            page[i] = -1;
+        }
+        font->pages[c >> PAGE_SHIFT] = page;
+    }
+
+    return page;
+}
+
+static inline double advance(MarkupMetricsCache *cache, CachedFont *font, uint16_t c) {
+    float *page = font->pages[c >> PAGE_SHIFT];
+
+    if (page == NULL && (page = makePage(font, c)) == NULL) {
+        // Out of memory, so just don't cache it
+        return cache->metrics.advance(cache->metrics.context, font->key, c);
+    }
+
+    float *cached = &page[c & (PAGE_CHARS - 1)];
+
+    if (*cached < 0) {
+        *cached = (float)cache->metrics.advance(cache->metrics.context, font->key, c);
+    }
+
+    return *cached;
+}
+
+// The tab stops are the indent, the second tab stop and then every indent.
+static double nextTab(const MarkupState *state, double x) {
+    if (state == NULL || state->style != MarkupStyleIndent) {
+        return (floor(x / DEFAULT_TAB_INTERVAL) + 1) * DEFAULT_TAB_INTERVAL;
+    }
+
+    double first = fmin(state->indent, state->tabStop);
+    double second = fmax(state->indent, state->tabStop);
+
+    if (x < first) {
+        return first;
+    }
+
+    if (x < second) {
+        return second;
+    }
+
+    double interval = state->indent > 0 ? state->indent : DEFAULT_TAB_INTERVAL;
+    return (floor(x / interval) + 1) * interval;
+}
+
+static inline double headIndent(const MarkupState *state) {
+    if (state->style != MarkupStyleIndent) {
+        return 0;
+    }
+    return state->indentToTab ? state->tabStop : state->indent;
+}
+
+static inline void finishLine(Layout *layout, double nextLineHeight) {
+    layout->height += layout->lineHeight;
+    layout->lineHeight = nextLineHeight;
+}
+
+// Lays out one character, or an attachment if c is 0
+static void layoutChar(Layout *layout,
+                       const MarkupState *state,
+                       double charWidth,
+                       double charHeight,
+                       uint16_t c) {
+    // The first character of a paragraph decides its style
+    if (layout->paragraph == NULL) {
+        layout->paragraph = state;
+        layout->headIndent = headIndent(state);
+    }
+
+    if (charHeight > layout->lineHeight) {
+        layout->lineHeight = charHeight;
+    }
+
+    switch (c) {
+    case '\n':
+        finishLine(layout, 0);
+        layout->x = 0;
+        layout->lineStart = 0;
+        layout->word = 0;
+        layout->paragraph = NULL;
+        layout->lineHasContent = false;
+        return;
+
+    case '\t':
+        layout->x = nextTab(layout->paragraph, layout->x);
+        layout->word = 0;
+
+        if (layout->x > layout->width && layout->lineHasContent) {
+            finishLine(layout, charHeight);
+            layout->x = layout->headIndent;
+            layout->lineStart = layout->headIndent;
+        }
+        layout->lineHasContent = true;
+        return;
+
+    case ' ':
+        // Spaces can hang off the end of a line
+        layout->x += charWidth;
+        layout->word = 0;
+        layout->lineHasContent = true;
+        return;
+    }
+
+    if (layout->x + charWidth > layout->width && layout->lineHasContent) {
+        if (layout->word > 0 && layout->word < layout->x - layout->lineStart) {
+            // Move the whole word down
+            finishLine(layout, charHeight);
+            layout->x = layout->headIndent + layout->word;
+        } else {
+            // The word is too long for a line so break it here
+            finishLine(layout, charHeight);
+            layout->x = layout->headIndent;
+            layout->word = 0;
+        }
+        layout->lineStart = layout->headIndent;
+    }
+
+    layout->x += charWidth;
+    layout->word += charWidth;
+    layout->lineHasContent = true;
+}
+
+double MarkupEstimateHeight(const uint16_t *src,
+                            const MarkupRunList *runs,
+                            double width,
+                            MarkupMetricsCache *cache) {
+    Layout layout = {0};
+    layout.width = width;
+
+    for (size_t r = 0; r < runs->count; r++) {
+        const MarkupRun *run = &runs->runs[r];
+        const MarkupState *state = &run->state;
+        CachedFont *font = cachedFont(cache, state);
+
+        if (run->kind != MarkupRunText) {
+            layoutChar(&layout, state, font->attachmentWidth, font->lineHeight, 0);
+            continue;
+        }
+
+        const uint16_t *text = src + run->start;
+
+        for (uint32_t i = 0; i < run->length; i++) {
+            layoutChar(&layout, state, advance(cache, font, text[i]), font->lineHeight, text[i]);
+        }
+
+        if (run->suffix != 0) {
+            layoutChar(&layout,
+                       state,
+                       advance(cache, font, run->suffix),
+                       font->lineHeight,
+                       run->suffix);
+        }
+    }
+
+    // A trailing new line does not add an empty line, as with TextKit
+    if (layout.lineHasContent) {
+        layout.height += layout.lineHeight;
+    }
+
+    return ceil(layout.height);
+}
@@ -0,0 +1,72 @@
+//
+//  MarkupEstimate.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plain C estimate of the height of some markup when laid out at a given
+// width, working from the runs in MarkupRuns.h instead of an attributed string.
+// It does a simple greedy word wrap with the indents and tab stops the markup
+// would use, so it is close enough for things like estimatedHeightForRow but
+// is not exact.
+//
+// The font measurements come from a provider, so this can be used without
+// UIKit. The results are cached, each character is only measured once for a
+// font, so keep the cache around between strings.
+
+#ifndef MarkupEstimate_h
+#define MarkupEstimate_h
+
+#include "MarkupRuns.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef struct {
+    double pointSize;
+    bool bold;
+    bool italic;
+    bool fixed;
+} MarkupFontKey;
+
+typedef struct {
+    void *context;
+    // Width of a single UTF-16 code unit
+    double (*advance)(void *context, MarkupFontKey font, uint16_t c);
+    double (*lineHeight)(void *context, MarkupFontKey font);
+    // Width of an SF symbol or image (#S, #F)
+    double (*attachmentWidth)(void *context, MarkupFontKey font);
+} MarkupMetrics;
+
+typedef struct MarkupMetricsCache MarkupMetricsCache;
+
+// Returns NULL if out of memory. Not thread safe, so use one per thread.
+MarkupMetricsCache *MarkupMetricsCacheCreate(const MarkupMetrics *metrics);
+void MarkupMetricsCacheFree(MarkupMetricsCache *cache);
+
+// src is the markup the runs were made from.
+double MarkupEstimateHeight(const uint16_t *src,
+                            const MarkupRunList *runs,
+                            double width,
+                            MarkupMetricsCache *cache);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !MarkupEstimate_h
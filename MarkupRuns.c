@@ -0,0 +1,513 @@
+//
+//  MarkupRuns.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MarkupRuns.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MARKUP_ESCAPE '#'
+#define MARKUP_ARG_END ' '
+
+#define FONT_DELTA_S (1.0)
+#define FONT_DELTA_M (2.0)
+#define FONT_DELTA_L (4.0)
+
+void MarkupStateInit(MarkupState *state, double pointSize) {
+    memset(state, 0, sizeof(*state));
+    state->pointSize = pointSize;
+    state->indent = 0;
+    state->tabStop = pointSize;
+    state->color = 'D';
+    state->style = MarkupStyleNone;
+}
+
+void MarkupRunListInit(MarkupRunList *list) {
+    list->runs = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+void MarkupRunListFree(MarkupRunList *list) {
+    free(list->runs);
+    MarkupRunListInit(list);
+}
+
+static bool appendRun(MarkupRunList *list,
+                      MarkupRunKind kind,
+                      size_t start,
+                      size_t length,
+                      uint16_t suffix,
+                      const MarkupState *state) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        MarkupRun *runs = realloc(list->runs, capacity * sizeof(MarkupRun));
+
+        if (runs == NULL) {
+            return false;
+        }
+
+        list->runs = runs;
+        list->capacity = capacity;
+    }
+
+    MarkupRun *run = &list->runs[list->count++];
+
+    run->start = (uint32_t)start;
+    run->length = (uint32_t)length;
+    run->suffix = suffix;
+    run->kind = (uint8_t)kind;
+    run->state = *state;
+    return true;
+}
+
+// indentStyleSize:tabStop:indentToTab: gives no style for a zero indent
+static inline void useIndentStyle(MarkupState *state) {
+    state->style = (state->indent == 0) ? MarkupStyleNone : MarkupStyleIndent;
+}
+
+// Scans an argument (link, symbol or image name) up to a space, and skips the
+// space. Returns the position after it.
+static inline size_t scanArgument(const uint16_t *src,
+                                  size_t len,
+                                  size_t pos,
+                                  size_t *argStart,
+                                  size_t *argLength) {
+    *argStart = pos;
+
+    while (pos < len && src[pos] != MARKUP_ARG_END) {
+        pos++;
+    }
+
+    *argLength = pos - *argStart;
+
+    if (pos < len) {
+        pos++;
+    }
+
+    return pos;
+}
+
+// Applies the state change for escape c. indentStep is the original point size.
+static inline void applyEscape(MarkupState *state, uint16_t c, double indentStep) {
+    switch (c) {
+    default:
+        break;
+    case 'b':
+        state->bold = !state->bold;
+        break;
+    case 'i':
+        state->italic = !state->italic;
+        break;
+    case '-':
+        if (state->pointSize > FONT_DELTA_S) {
+            state->pointSize -= FONT_DELTA_S;
+        }
+        break;
+    case '+':
+        state->pointSize += FONT_DELTA_S;
+        break;
+    case '(':
+        if (state->pointSize > FONT_DELTA_M) {
+            state->pointSize -= FONT_DELTA_M;
+        }
+        break;
+    case ')':
+        state->pointSize += FONT_DELTA_M;
+        break;
+    case '[':
+        if (state->pointSize > FONT_DELTA_L) {
+            state->pointSize -= FONT_DELTA_L;
+        }
+        break;
+    case ']':
+        state->pointSize += FONT_DELTA_L;
+        break;
+    case '0':
+    case 'O':
+    case 'G':
+    case 'A':
+    case 'K':
+    case 'R':
+    case 'B':
+    case 'C':
+    case 'Y':
+    case 'N':
+    case 'M':
+    case 'W':
+    case 'D':
+    case '!':
+    case 'U':
+    case 'E':
+        state->color = c;
+        break;
+    case '>':
+        state->indent += indentStep;
+        useIndentStyle(state);
+        break;
+    case '2':
+        state->indentToTab = !state->indentToTab;
+        useIndentStyle(state);
+        break;
+    case '<':
+        if (state->indent > 0) {
+            state->indent -= indentStep;
+        }
+        useIndentStyle(state);
+        break;
+    case '~':
+        state->tabStop += indentStep * 5;
+        useIndentStyle(state);
+        break;
+    case '.':
+        if (state->tabStop > 0) {
+            state->tabStop -= indentStep * 5;
+            useIndentStyle(state);
+        }
+        break;
+    case '|':
+        state->center = !state->center;
+        state->style = MarkupStyleCenter;
+        break;
+    case 'T':
+        state->linkStart = 0;
+        state->linkLength = 0;
+        break;
+    case 'X':
+        state->fixed = true;
+        break;
+    case 'P':
+        state->fixed = false;
+        break;
+    }
+}
+
+void MarkupSummaryInit(MarkupSummary *summary) {
+    memset(summary, 0, sizeof(*summary));
+}
+
+void MarkupSummaryFree(MarkupSummary *summary) {
+    free(summary->escapes);
+    MarkupSummaryInit(summary);
+}
+
+static bool addSummaryEscape(MarkupSummary *summary, uint16_t c) {
+    if (summary->escapeCount == summary->escapeCapacity) {
+        size_t capacity = summary->escapeCapacity ? summary->escapeCapacity * 2 : 16;
+        uint16_t *escapes = realloc(summary->escapes, capacity * sizeof(uint16_t));
+
+        if (escapes == NULL) {
+            return false;
+        }
+
+        summary->escapes = escapes;
+        summary->escapeCapacity = capacity;
+    }
+
+    summary->escapes[summary->escapeCount++] = c;
+    return true;
+}
+
+// Adds escape c to the summary, see applyEscape for what they do
+static bool summarizeEscape(MarkupSummary *summary, uint16_t c) {
+    switch (c) {
+    default:
+        break;
+    case 'b':
+        summary->flipBold = !summary->flipBold;
+        break;
+    case 'i':
+        summary->flipItalic = !summary->flipItalic;
+        break;
+    case '0':
+    case 'O':
+    case 'G':
+    case 'A':
+    case 'K':
+    case 'R':
+    case 'B':
+    case 'C':
+    case 'Y':
+    case 'N':
+    case 'M':
+    case 'W':
+    case 'D':
+    case '!':
+    case 'U':
+    case 'E':
+        summary->setColor = true;
+        summary->color = c;
+        break;
+    case 'T':
+        summary->setLink = true;
+        summary->linkStart = 0;
+        summary->linkLength = 0;
+        break;
+    case 'X':
+    case 'P':
+        summary->setFixed = true;
+        summary->fixed = (c == 'X');
+        break;
+    case '-':
+    case '+':
+    case '(':
+    case ')':
+    case '[':
+    case ']':
+    case '>':
+    case '2':
+    case '<':
+    case '~':
+    case '.':
+    case '|':
+        return addSummaryEscape(summary, c);
+    }
+    return true;
+}
+
+static inline bool appendLastText(MarkupRunList *runs,
+                                  size_t textStart,
+                                  size_t textLength,
+                                  const MarkupState *state) {
+    if (textLength == 0) {
+        return true;
+    }
+
+    // The last piece of text never has a link
+    MarkupState last = *state;
+    last.linkStart = 0;
+    last.linkLength = 0;
+
+    return appendRun(runs, MarkupRunText, textStart, textLength, 0, &last);
+}
+
+// Either tokenizes into runs, updating state, or summarizes into summary. It
+// never reads past end, as the chunk bounds are always just after a space.
+static bool scanRange(const uint16_t *src,
+                      size_t len,
+                      size_t start,
+                      size_t end,
+                      double pointSize,
+                      MarkupState *state,
+                      MarkupRunList *runs,
+                      MarkupSummary *summary) {
+    size_t pos = start;
+
+    while (pos < end) {
+        size_t textStart = pos;
+
+        while (pos < end && src[pos] != MARKUP_ESCAPE) {
+            pos++;
+        }
+
+        size_t textLength = pos - textStart;
+
+        if (pos < end) {
+            pos++;
+        }
+
+        if (pos >= end) {
+            if (runs == NULL) {
+                break;
+            }
+
+            if (end == len) {
+                if (!appendLastText(runs, textStart, textLength, state)) {
+                    return false;
+                }
+            } else if (textLength > 0) {
+                // The next chunk starts with an escape that would have ended
+                // this text anyway
+                if (!appendRun(runs, MarkupRunText, textStart, textLength, 0, state)) {
+                    return false;
+                }
+            }
+            break;
+        }
+
+        uint16_t c = src[pos++];
+        uint16_t suffix = 0;
+
+        switch (c) {
+        case 'h':
+        case '#':
+            suffix = '#';
+            break;
+        case 't':
+            suffix = '\t';
+            break;
+        case 'n':
+            suffix = '\n';
+            break;
+        }
+
+        if (runs != NULL && (textLength > 0 || suffix != 0)) {
+            if (!appendRun(runs, MarkupRunText, textStart, textLength, suffix, state)) {
+                return false;
+            }
+        }
+
+        size_t argStart = 0;
+        size_t argLength = 0;
+
+        switch (c) {
+        case 'L':
+            pos = scanArgument(src, end, pos, &argStart, &argLength);
+
+            if (summary != NULL) {
+                summary->setLink = true;
+                summary->linkStart = (uint32_t)argStart;
+                summary->linkLength = (uint32_t)argLength;
+            } else {
+                state->linkStart = (uint32_t)argStart;
+                state->linkLength = (uint32_t)argLength;
+            }
+            break;
+        case 'S':
+        case 'F':
+            pos = scanArgument(src, end, pos, &argStart, &argLength);
+
+            if (runs != NULL && argLength > 0 &&
+                !appendRun(runs,
+                           c == 'S' ? MarkupRunSymbol : MarkupRunImage,
+                           argStart,
+                           argLength,
+                           0,
+                           state)) {
+                return false;
+            }
+            break;
+        default:
+            if (summary != NULL) {
+                if (!summarizeEscape(summary, c)) {
+                    return false;
+                }
+            } else {
+                applyEscape(state, c, pointSize);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool MarkupTokenize(const uint16_t *src, size_t len, double pointSize, MarkupRunList *runs) {
+    MarkupState state;
+
+    MarkupStateInit(&state, pointSize);
+    return scanRange(src, len, 0, len, pointSize, &state, runs, NULL);
+}
+
+bool MarkupTokenizeRange(const uint16_t *src,
+                         size_t len,
+                         size_t start,
+                         size_t end,
+                         double pointSize,
+                         MarkupState *state,
+                         MarkupRunList *runs) {
+    return scanRange(src, len, start, end, pointSize, state, runs, NULL);
+}
+
+bool MarkupSummarize(const uint16_t *src,
+                     size_t len,
+                     size_t start,
+                     size_t end,
+                     MarkupSummary *summary) {
+    return scanRange(src, len, start, end, 0, NULL, NULL, summary);
+}
+
+void MarkupSummaryApply(const MarkupSummary *summary, MarkupState *state, double pointSize) {
+    if (summary->flipBold) {
+        state->bold = !state->bold;
+    }
+
+    if (summary->flipItalic) {
+        state->italic = !state->italic;
+    }
+
+    if (summary->setColor) {
+        state->color = summary->color;
+    }
+
+    if (summary->setLink) {
+        state->linkStart = summary->linkStart;
+        state->linkLength = summary->linkLength;
+    }
+
+    if (summary->setFixed) {
+        state->fixed = summary->fixed;
+    }
+
+    // These only touch the point size, indents and style so can be replayed
+    // after the rest
+    for (size_t i = 0; i < summary->escapeCount; i++) {
+        applyEscape(state, summary->escapes[i], pointSize);
+    }
+}
+
+// A chunk can start at p if the character before is a space, as a space always
+// ends an escape or argument, and p is an escape that does not add to the text
+// before it, so no run goes over the split.
+static inline bool canSplitAt(const uint16_t *src, size_t len, size_t p) {
+    if (p < 1 || p + 1 >= len) {
+        return false;
+    }
+
+    if (src[p - 1] != MARKUP_ARG_END || src[p] != MARKUP_ESCAPE) {
+        return false;
+    }
+
+    switch (src[p + 1]) {
+    case 'h':
+    case '#':
+    case 't':
+    case 'n':
+        return false;
+    default:
+        return true;
+    }
+}
+
+size_t MarkupSplitChunks(const uint16_t *src, size_t len, size_t maxChunks, size_t *bounds) {
+    size_t chunks = 0;
+
+    bounds[0] = 0;
+
+    for (size_t k = 1; k < maxChunks; k++) {
+        size_t p = len / maxChunks * k;
+
+        if (p <= bounds[chunks]) {
+            p = bounds[chunks] + 1;
+        }
+
+        while (p < len && !canSplitAt(src, len, p)) {
+            p++;
+        }
+
+        if (p >= len) {
+            break;
+        }
+
+        bounds[++chunks] = p;
+    }
+
+    bounds[++chunks] = len;
+    return chunks;
+}
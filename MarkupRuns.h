@@ -0,0 +1,150 @@
+//
+//  MarkupRuns.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plain C tokenizer for the markup described in NSString+Markup.h. It turns
+// the UTF-16 markup into a list of runs, each with the formatting state that
+// applies to it, without needing UIKit. The state follows the same rules as
+// attributedStringFromMarkUpWithFont:.
+
+#ifndef MarkupRuns_h
+#define MarkupRuns_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef enum {
+    MarkupStyleNone = 0, // Default paragraph style
+    MarkupStyleIndent,   // Uses indent, tabStop and indentToTab
+    MarkupStyleCenter,   // Centered or left, from center
+} MarkupStyleKind;
+
+typedef struct {
+    double pointSize;
+    double indent;  // Current indent from #> and #<
+    double tabStop; // Second tab stop from #~ and #.
+    uint32_t linkStart;
+    uint32_t linkLength; // Zero for no link. The link is still percent encoded.
+    uint16_t color;      // The markup color character, e.g. 'D'
+    uint8_t style;       // MarkupStyleKind
+    bool bold;
+    bool italic;
+    bool fixed; // #X
+    bool center;
+    bool indentToTab;
+} MarkupState;
+
+typedef enum {
+    MarkupRunText = 0,
+    MarkupRunSymbol, // #S - start and length are the symbol name
+    MarkupRunImage,  // #F - start and length are the image name
+} MarkupRunKind;
+
+typedef struct {
+    uint32_t start;
+    uint32_t length;
+    uint16_t suffix; // A character from an escape (#h, #t, #n) after the text, or 0
+    uint8_t kind;    // MarkupRunKind
+    MarkupState state;
+} MarkupRun;
+
+typedef struct {
+    MarkupRun *runs;
+    size_t count;
+    size_t capacity;
+} MarkupRunList;
+
+// How a piece of markup changes the state, so the state at the start of each
+// piece can be found without tokenizing all the ones before it. Toggles and
+// things that are just set are kept as the end result, the rest (point size,
+// indents and paragraph style, which depend on the value coming in) are kept
+// as the escapes to replay.
+typedef struct {
+    bool flipBold;
+    bool flipItalic;
+    bool setColor;
+    bool setLink;
+    bool setFixed;
+    bool fixed;
+    uint16_t color;
+    uint32_t linkStart;
+    uint32_t linkLength;
+    uint16_t *escapes;
+    size_t escapeCount;
+    size_t escapeCapacity;
+} MarkupSummary;
+
+// The state at the start of a string for a font of the given size.
+void MarkupStateInit(MarkupState *state, double pointSize);
+
+void MarkupRunListInit(MarkupRunList *list);
+void MarkupRunListFree(MarkupRunList *list);
+
+// Tokenizes the whole string, appending to runs. Returns false if it ran out of
+// memory.
+bool MarkupTokenize(const uint16_t *src, size_t len, double pointSize, MarkupRunList *runs);
+
+// Parallel tokenizing
+//
+// The string is split into chunks at points where the tokenizer is always
+// between escapes and where no run crosses the split, so tokenizing the chunks
+// separately gives exactly the same runs as tokenizing the whole string. Each
+// chunk is summarized (in parallel), the summaries are applied in order to get
+// the state at the start of each chunk, then each chunk is tokenized (in
+// parallel) and the run lists joined.
+
+// Fills bounds with up to maxChunks + 1 positions, starting with 0 and ending
+// with len. Returns the number of chunks, which may be fewer than asked for if
+// there are not enough places to split.
+size_t MarkupSplitChunks(const uint16_t *src, size_t len, size_t maxChunks, size_t *bounds);
+
+void MarkupSummaryInit(MarkupSummary *summary);
+void MarkupSummaryFree(MarkupSummary *summary);
+
+// Summarizes src[start] .. src[end], where start and end are chunk bounds.
+bool MarkupSummarize(const uint16_t *src,
+                     size_t len,
+                     size_t start,
+                     size_t end,
+                     MarkupSummary *summary);
+
+// Updates state to be the state after the summarized chunk. pointSize is the
+// original point size as passed to MarkupStateInit.
+void MarkupSummaryApply(const MarkupSummary *summary, MarkupState *state, double pointSize);
+
+// Tokenizes src[start] .. src[end] starting with state, which is updated to
+// the state at the end. start and end must be chunk bounds.
+bool MarkupTokenizeRange(const uint16_t *src,
+                         size_t len,
+                         size_t start,
+                         size_t end,
+                         double pointSize,
+                         MarkupState *state,
+                         MarkupRunList *runs);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !MarkupRuns_h
@@ -0,0 +1,39 @@
+//
+//  MarkupSizeEstimator.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Estimates the height of markup without making the attributed string or
+// laying it out, e.g. for estimatedHeightForRow. Keep one around for a font
+// as it caches the character widths. Use it from one thread only.
+
+@interface MarkupSizeEstimator : NSObject
+
++ (instancetype)estimatorWithFont:(UIFont *)font;
+- (instancetype)initWithFont:(UIFont *)font;
+- (instancetype)init NS_UNAVAILABLE;
+
+- (CGFloat)heightForMarkUp:(NSString *)markup width:(CGFloat)width;
+
+@end
+
+NS_ASSUME_NONNULL_END
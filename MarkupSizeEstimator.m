@@ -0,0 +1,153 @@
+//
+//  MarkupSizeEstimator.m
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "MarkupSizeEstimator.h"
+#import "MarkupEstimate.h"
+#import <CoreText/CoreText.h>
+
+#define STACK_MARKUP 1024
+
+@interface MarkupSizeEstimator ()
+
+@property (nonatomic, strong) UIFont *font;
+
+// The last font made for a key - the cache asks for the same one many times
+@property (nonatomic, strong) UIFont *lastFont;
+@property (nonatomic) MarkupFontKey lastKey;
+
+- (UIFont *)fontForKey:(MarkupFontKey)key;
+
+@end
+
+static double markupAdvance(void *context, MarkupFontKey key, uint16_t c) {
+    MarkupSizeEstimator *estimator = (__bridge MarkupSizeEstimator *)context;
+    UIFont *font = [estimator fontForKey:key];
+
+    if (CFStringIsSurrogateHighCharacter(c) || CFStringIsSurrogateLowCharacter(c)) {
+        // Half of something like an emoji
+        return font.pointSize / 2;
+    }
+
+    // The font's own glyph is much cheaper to measure than laying out a string
+    UniChar ch = c;
+    CGGlyph glyph = 0;
+    CTFontRef ctFont = (__bridge CTFontRef)font;
+
+    if (CTFontGetGlyphsForCharacters(ctFont, &ch, &glyph, 1)) {
+        return CTFontGetAdvancesForGlyphs(ctFont, kCTFontOrientationHorizontal, &glyph, NULL, 1);
+    }
+
+    // Not in the font, so let TextKit find a fallback font for it
+    NSString *str = [NSString stringWithCharacters:&ch length:1];
+    return [str sizeWithAttributes:@{NSFontAttributeName : font}].width;
+}
+
+static double markupLineHeight(void *context, MarkupFontKey key) {
+    MarkupSizeEstimator *estimator = (__bridge MarkupSizeEstimator *)context;
+    return [estimator fontForKey:key].lineHeight;
+}
+
+static double markupAttachmentWidth(void *context, MarkupFontKey key) {
+    MarkupSizeEstimator *estimator = (__bridge MarkupSizeEstimator *)context;
+
+    // Symbols and images are drawn at the cap height, and most are about square
+    return [estimator fontForKey:key].capHeight;
+}
+
+@implementation MarkupSizeEstimator {
+    MarkupMetricsCache *_cache;
+}
+
++ (instancetype)estimatorWithFont:(UIFont *)font {
+    return [[[self class] alloc] initWithFont:font];
+}
+
+- (instancetype)initWithFont:(UIFont *)font {
+    if ((self = [super init])) {
+        self.font = font;
+
+        // The cache keeps an unretained pointer back to us
+        MarkupMetrics metrics = {(__bridge void *)self,
+                                 markupAdvance,
+                                 markupLineHeight,
+                                 markupAttachmentWidth};
+        _cache = MarkupMetricsCacheCreate(&metrics);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    MarkupMetricsCacheFree(_cache);
+}
+
+// Makes the same font as updateFont:pointSize:bold:italic: in NSString+Markup
+- (UIFont *)fontForKey:(MarkupFontKey)key {
+    MarkupFontKey last = self.lastKey;
+
+    if (self.lastFont != nil && last.pointSize == key.pointSize && last.bold == key.bold &&
+        last.italic == key.italic && last.fixed == key.fixed) {
+        return self.lastFont;
+    }
+
+    UIFont *base = key.fixed ? [UIFont fontWithName:@"Menlo-Bold" size:key.pointSize] : self.font;
+    uint32_t traits = (key.bold ? UIFontDescriptorTraitBold : 0) |
+                      (key.italic ? UIFontDescriptorTraitItalic : 0);
+    UIFontDescriptor *descriptor = [base.fontDescriptor fontDescriptorWithSymbolicTraits:traits];
+    UIFont *font = [UIFont fontWithDescriptor:descriptor size:key.pointSize];
+
+    self.lastKey = key;
+    self.lastFont = font;
+    return font;
+}
+
+- (CGFloat)heightForMarkUp:(NSString *)markup width:(CGFloat)width {
+    if (_cache == NULL) {
+        return 0;
+    }
+
+    NSUInteger len = markup.length;
+    unichar stackChars[STACK_MARKUP];
+    unichar *chars = len <= STACK_MARKUP ? stackChars : malloc(len * sizeof(unichar));
+
+    if (chars == NULL) {
+        return 0;
+    }
+
+    [markup getCharacters:chars range:NSMakeRange(0, len)];
+
+    MarkupRunList runs;
+    double height = 0;
+
+    MarkupRunListInit(&runs);
+
+    if (MarkupTokenize(chars, len, self.font.pointSize, &runs)) {
+        height = MarkupEstimateHeight(chars, &runs, width, _cache);
+    }
+
+    MarkupRunListFree(&runs);
+
+    if (chars != stackChars) {
+        free(chars);
+    }
+
+    return height;
+}
+
+@end
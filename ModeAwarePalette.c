@@ -0,0 +1,59 @@
+//
+//  ModeAwarePalette.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ModeAwarePalette.h"
+
+// Text and alert are not here as they use the dynamic labelColor
+static const uint32_t palette[ModeAwareAppearanceCount][ModeAwareColorCount] = {
+    [ModeAwareAppearanceLight] =
+        {
+            [ModeAwareColorBlue] = 0x0066FFFF,
+            [ModeAwareColorGrayText] = 0x808080FF, // grayColor
+        },
+    [ModeAwareAppearanceDark] =
+        {
+            // Based on the "information icon" (i) color
+            [ModeAwareColorBlue] = 0x0099FFFF,
+            [ModeAwareColorGrayText] = 0xAAAAAAFF, // lightGrayColor
+        },
+};
+
+uint32_t ModeAwarePaletteRGBA(ModeAwareAppearance appearance, ModeAwareColor color) {
+    if ((unsigned)appearance >= ModeAwareAppearanceCount ||
+        (unsigned)color >= ModeAwareColorCount) {
+        return 0;
+    }
+    return palette[appearance][color];
+}
+
+ModeAwareColor ModeAwareColorForMarkup(uint16_t c) {
+    switch (c) {
+    case 'D':
+        return ModeAwareColorText;
+    case '!':
+        return ModeAwareColorAlert;
+    case 'U':
+        return ModeAwareColorBlue;
+    case 'K':
+        return ModeAwareColorGrayText;
+    default:
+        return ModeAwareColorNone;
+    }
+}
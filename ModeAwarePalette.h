@@ -0,0 +1,69 @@
+//
+//  ModeAwarePalette.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The dark mode aware colors as plain C, so the markup and UIColor (DarkMode)
+// agree on what each one is in each appearance. Colors are packed 0xRRGGBBAA
+// as in HexColor.h. Text and alert are not in the table, UIColor (DarkMode)
+// uses labelColor for them as it is already dynamic.
+
+#ifndef ModeAwarePalette_h
+#define ModeAwarePalette_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef enum {
+    ModeAwareAppearanceLight = 0,
+    ModeAwareAppearanceDark,
+    ModeAwareAppearanceCount
+} ModeAwareAppearance;
+
+// These values are stored in attributed strings so only add to the end.
+typedef enum {
+    ModeAwareColorNone = 0,
+    ModeAwareColorText,     // #D - black or white
+    ModeAwareColorAlert,    // #! - currently the same as text
+    ModeAwareColorBlue,     // #U
+    ModeAwareColorGrayText, // #K
+    ModeAwareColorCount
+} ModeAwareColor;
+
+// Returns the color for the appearance, or 0 for ModeAwareColorNone and the
+// colors that are not in the table (ModeAwarePaletteUsesLabelColor).
+uint32_t ModeAwarePaletteRGBA(ModeAwareAppearance appearance, ModeAwareColor color);
+
+// True for the colors that are shown with labelColor rather than the table.
+static inline bool ModeAwarePaletteUsesLabelColor(ModeAwareColor color) {
+    return color == ModeAwareColorText || color == ModeAwareColorAlert;
+}
+
+// Returns the mode aware color for a markup color character (e.g. 'U' for #U),
+// or ModeAwareColorNone if it is a fixed color.
+ModeAwareColor ModeAwareColorForMarkup(uint16_t c);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !ModeAwarePalette_h
@@ -34,11 +34,17 @@ NS_ASSUME_NONNULL_BEGIN
 - (unichar)firstUnichar;
 - (unichar)lastUnichar;
 
-// URL encoding helpers
+// URL encoding helpers - these return the string itself if nothing needs encoding
 - (NSString *_Nonnull)percentEncodeUrl;
 - (NSString *_Nonnull)fullyPercentEncodeString;
+- (NSString *_Nullable)percentDecodeString;
 
-// Search helpers
+// Builds base?name=value&name=value in one buffer, with each name and value
+// fully percent encoded. If base already has a query the items are added to it.
++ (NSString *_Nonnull)urlString:(NSString *_Nonnull)base
+                 withQueryItems:(NSArray<NSURLQueryItem *> *_Nonnull)items;
+
+// Search helpers - for searching many strings use SubstringSearchIndex
 - (bool)hasCaseInsensitiveSubstring:(NSString *_Nonnull)search;
 
 // UI helpers
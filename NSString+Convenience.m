@@ -20,10 +20,98 @@
 
 #import "DebugLogging.h"
 #import "NSString+Convenience.h"
+#import "PercentEncoding.h"
 #import "TaskDispatch.h"
 
 #define DEBUG_LEVEL_FOR_FILE LogMarkup
 
+// Most URL components fit on the stack
+#define PERCENT_STACK_BUFFER 512
+
+// Gets the UTF-8 without copying if the string already has it, otherwise data
+// keeps the converted bytes. The length comes from the string and not strlen,
+// as the string may have a NUL in it. Returns NULL if the string cannot be
+// converted (e.g. it has a lone surrogate).
+static inline const uint8_t *utf8Bytes(NSString *str, size_t *len, NSData **data) {
+    CFStringRef cfStr = (__bridge CFStringRef)str;
+    const char *bytes = CFStringGetCStringPtr(cfStr, kCFStringEncodingUTF8);
+
+    if (bytes != NULL) {
+        // Only ASCII is kept as UTF-8, so there is one byte per character
+        *len = (size_t)CFStringGetLength(cfStr);
+        return (const uint8_t *)bytes;
+    }
+
+    *data = [str dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:NO];
+    *len = (*data).length;
+    return *data ? (const uint8_t *)(*data).bytes : NULL;
+}
+
+static NSString *foundationPercentEncode(NSString *str, PercentEncodeSet set) {
+    if (set == PercentEncodeUrlPath) {
+        return [str
+            stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet
+                                                                   .URLPathAllowedCharacterSet];
+    }
+    return [str
+        stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet.alphanumericCharacterSet];
+}
+
+// alphanumericCharacterSet includes non-ASCII letters, which Foundation leaves
+// alone, so those strings are left to Foundation to keep the same results.
+static inline bool needsFoundation(const uint8_t *bytes, size_t len, PercentEncodeSet set) {
+    return bytes == NULL ||
+           (set == PercentEncodeAlphanumeric && PercentAsciiPrefix(bytes, len) != len);
+}
+
+static bool appendPercentEncoded(PercentBuffer *buf, NSString *str, PercentEncodeSet set) {
+    size_t len = 0;
+    NSData *data = nil;
+    const uint8_t *bytes = utf8Bytes(str, &len, &data);
+
+    if (needsFoundation(bytes, len, set)) {
+        NSString *encoded = foundationPercentEncode(str, set);
+        bytes = utf8Bytes(encoded, &len, &data);
+        return bytes != NULL && PercentBufferAppend(buf, bytes, len);
+    }
+
+    return PercentEncodeAppend(buf, bytes, len, set);
+}
+
+static NSString *percentEncode(NSString *str, PercentEncodeSet set) {
+    size_t len = 0;
+    NSData *data = nil;
+    const uint8_t *bytes = utf8Bytes(str, &len, &data);
+
+    if (needsFoundation(bytes, len, set)) {
+        return foundationPercentEncode(str, set);
+    }
+
+    size_t safe = PercentEncodeSafePrefix(bytes, len, set);
+
+    if (safe == len) {
+        return str.copy;
+    }
+
+    char storage[PERCENT_STACK_BUFFER];
+    PercentBuffer buf;
+    NSString *result = nil;
+
+    PercentBufferInit(&buf, storage, sizeof(storage));
+
+    if (PercentBufferAppend(&buf, bytes, safe) &&
+        PercentEncodeAppend(&buf, bytes + safe, len - safe, set)) {
+        result = [[NSString alloc] initWithBytes:buf.bytes
+                                          length:buf.length
+                                        encoding:NSASCIIStringEncoding];
+    } else {
+        result = foundationPercentEncode(str, set);
+    }
+
+    PercentBufferFree(&buf);
+    return result;
+}
+
 @implementation NSString (Convenience)
 
 - (unichar)firstUnichar {
@@ -126,14 +214,92 @@
 }
 
 - (NSString *)percentEncodeUrl {
-    return
-        [self stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet
-                                                                     .URLPathAllowedCharacterSet];
+    return percentEncode(self, PercentEncodeUrlPath);
 }
 
 - (NSString *)fullyPercentEncodeString {
-    return [self
-        stringByAddingPercentEncodingWithAllowedCharacters:NSCharacterSet.alphanumericCharacterSet];
+    return percentEncode(self, PercentEncodeAlphanumeric);
+}
+
+- (NSString *)percentDecodeString {
+    size_t len = 0;
+    NSData *data = nil;
+    const uint8_t *bytes = utf8Bytes(self, &len, &data);
+
+    if (bytes == NULL) {
+        return self.stringByRemovingPercentEncoding;
+    }
+
+    if (memchr(bytes, '%', len) == NULL) {
+        return self.copy;
+    }
+
+    char storage[PERCENT_STACK_BUFFER];
+    PercentBuffer buf;
+    NSString *result = nil;
+
+    PercentBufferInit(&buf, storage, sizeof(storage));
+
+    // Invalid UTF-8 after decoding gives nil, as stringByRemovingPercentEncoding does
+    if (PercentDecodeAppend(&buf, bytes, len)) {
+        result = [[NSString alloc] initWithBytes:buf.bytes
+                                          length:buf.length
+                                        encoding:NSUTF8StringEncoding];
+    }
+
+    PercentBufferFree(&buf);
+    return result;
+}
+
++ (NSString *)urlString:(NSString *)base withQueryItems:(NSArray<NSURLQueryItem *> *)items {
+    if (items.count == 0) {
+        return base;
+    }
+
+    size_t len = 0;
+    NSData *data = nil;
+    const uint8_t *bytes = utf8Bytes(base, &len, &data);
+
+    if (bytes == NULL) {
+        return base;
+    }
+
+    char storage[PERCENT_STACK_BUFFER];
+    PercentBuffer buf;
+    bool ok = true;
+    char separator = (memchr(bytes, '?', len) == NULL) ? '?' : '&';
+
+    PercentBufferInit(&buf, storage, sizeof(storage));
+    ok = PercentBufferAppend(&buf, bytes, len);
+
+    for (NSURLQueryItem *item in items) {
+        if (!ok) {
+            break;
+        }
+
+        ok = PercentBufferAppend(&buf, &separator, 1) &&
+             appendPercentEncoded(&buf, item.name, PercentEncodeAlphanumeric);
+
+        if (ok && item.value != nil) {
+            ok = PercentBufferAppend(&buf, "=", 1) &&
+                 appendPercentEncoded(&buf, item.value, PercentEncodeAlphanumeric);
+        }
+
+        separator = '&';
+    }
+
+    NSString *result = base;
+
+    if (ok) {
+        result = [[NSString alloc] initWithBytes:buf.bytes
+                                          length:buf.length
+                                        encoding:NSUTF8StringEncoding];
+    } else {
+        ERROR_LOG(@"Could not build URL for %@\n", base);
+    }
+
+    PercentBufferFree(&buf);
+    return result;
 }
 
 - (bool)hasCaseInsensitiveSubstring:(NSString *)search {
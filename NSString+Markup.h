@@ -33,6 +33,10 @@
 typedef UIImage *_Nullable (^SafeSystemImageBlock)(NSString *_Nonnull name,
                                                    UIImageSymbolConfiguration *_Nullable config);
 
+// Text using a dark mode aware color (#D, #!, #U, #K) is tagged with this
+// attribute. The value is an NSNumber holding a ModeAwareColor.
+extern NSAttributedStringKey const _Nonnull MarkupColorTokenAttributeName;
+
 @interface NSString (Markup)
 
 // A simple markup for basic text formatting.
@@ -57,6 +61,8 @@ typedef UIImage *_Nullable (^SafeSystemImageBlock)(NSString *_Nonnull name,
 // #P pop back original font
 
 // Colors:
+// The dark mode aware colors can be updated after the appearance changes by
+// calling updateMarkupColors on the string, there is no need to parse it again.
 // #D - dark mode aware text (black or white)
 // #! - dark mode aware system-wide alert color (yellow or black)
 // #U - dark mode aware blue.
@@ -95,6 +101,18 @@ typedef UIImage *_Nullable (^SafeSystemImageBlock)(NSString *_Nonnull name,
                                                                 fixedFont:
                                                                     (UIFont *_Nullable)fixedFont;
 
+// The methods above are always done on the calling thread. With parallel,
+// strings of 64K characters or more are split into chunks that are tokenized
+// and rendered at the same time on all the cores, giving the same result as the
+// methods above. Shorter strings use the methods above. The colors
+// are looked up on the calling thread first, but the fonts, #S symbols
+// (including the SafeSystemImage block) and #F images are made on worker
+// threads, so only use it if those are safe off the main thread.
+- (NSMutableAttributedString *_Nonnull)attributedStringFromMarkUpWithFont:(UIFont *_Nullable)font
+                                                                fixedFont:
+                                                                    (UIFont *_Nullable)fixedFont
+                                                                 parallel:(bool)parallel;
+
 // This function adds extra #s to a string so they will not be interpreted as
 // markup
 - (NSString *_Nonnull)safeEscapeForMarkUp;
@@ -120,3 +138,11 @@ typedef UIImage *_Nullable (^SafeSystemImageBlock)(NSString *_Nonnull name,
 + (void)setSystemImageAlternatives:(SafeSystemImageBlock _Nonnull)block;
 
 @end
+
+@interface NSMutableAttributedString (Markup)
+
+// Recolors the dark mode aware parts of a string made from markup for the
+// current appearance. Call after UIColor modeAwareAppearanceChanged.
+- (void)updateMarkupColors;
+
+@end
@@ -23,6 +23,7 @@
 
 #import "DebugLogging.h"
 #import "NSString+Convenience.h"
+#import "MarkupRuns.h"
 #import "NSString+Markup.h"
 #import "TaskDispatch.h"
 #import "UIColor+DarkMode.h"
@@ -32,6 +33,14 @@
 #define MARKUP_ESCAPE @"#"
 #define NEWL @"\n"
 
+// Markup shorter than this is not worth splitting up
+#define MARKUP_PARALLEL_LENGTH (64 * 1024)
+
+// Markup color characters are all ASCII
+#define MARKUP_COLOR_CHARS 128
+
+NSAttributedStringKey const MarkupColorTokenAttributeName = @"MarkupColorToken";
+
 @implementation NSString (Markup)
 
 - (UIFont *)updateFont:(UIFont *)font
@@ -51,6 +60,7 @@
 - (void)addSegmentToString:(UIFont *)font
                      style:(NSParagraphStyle *)style
                      color:(UIColor *)color
+                colorToken:(ModeAwareColor)colorToken
                       link:(NSString *)link
                     string:(NSMutableAttributedString *)string {
     // DEBUG_LOG_NSString(substring);
@@ -66,6 +76,10 @@
     attr[NSFontAttributeName] = font;
     attr[NSForegroundColorAttributeName] = color;
 
+    if (colorToken != ModeAwareColorNone) {
+        attr[MarkupColorTokenAttributeName] = @(colorToken);
+    }
+
     if (style) {
         attr[NSParagraphStyleAttributeName] = style;
     }
@@ -275,6 +289,272 @@ static SafeSystemImageBlock safeSystemImage =
     return [NSAttributedString attributedStringWithAttachment:attachment];
 }
 
+static UIColor *colorForMarkup(uint16_t c) {
+    ModeAwareColor token = ModeAwareColorForMarkup(c);
+
+    if (token != ModeAwareColorNone) {
+        return [UIColor modeAwareColor:token];
+    }
+
+    switch (c) {
+    case '0':
+        return [UIColor blackColor];
+    case 'O':
+        return [UIColor orangeColor];
+    case 'G':
+        return [UIColor greenColor];
+    case 'A':
+        return [UIColor grayColor];
+    case 'R':
+        return [UIColor redColor];
+    case 'B':
+        return [UIColor blueColor];
+    case 'C':
+        return [UIColor cyanColor];
+    case 'Y':
+        return [UIColor yellowColor];
+    case 'N':
+        return [UIColor brownColor];
+    case 'M':
+        return [UIColor magentaColor];
+    case 'W':
+        return [UIColor whiteColor];
+    case 'E':
+        return [UIColor colorNamed:@"AccentColor"];
+    default:
+        return [UIColor modeAwareText];
+    }
+}
+
+static id colorOrNull(UIColor *color) {
+    return color ? color : [NSNull null];
+}
+
+// The colors for each markup color character, made on the calling thread
+// before going parallel so UIKit is never asked for a color on a worker thread.
+// Anything that is not a color character is text colored. A color can be
+// missing (#E when the app has no AccentColor), so the table must allow for
+// that - missing ones are NSNull, and are no color at all when rendered.
+static NSArray *markupColors(void) {
+    static const char colorChars[] = "0OGAKRBCYNMWD!UE";
+    NSMutableArray *colors = [NSMutableArray arrayWithCapacity:MARKUP_COLOR_CHARS];
+    id text = colorOrNull(colorForMarkup('D'));
+
+    for (size_t c = 0; c < MARKUP_COLOR_CHARS; c++) {
+        [colors addObject:text];
+    }
+
+    for (const char *c = colorChars; *c != 0; c++) {
+        colors[(NSUInteger)*c] = colorOrNull(colorForMarkup((uint16_t)*c));
+    }
+
+    return colors;
+}
+
+- (NSParagraphStyle *)styleForMarkUpState:(const MarkupState *)state {
+    switch (state->style) {
+    case MarkupStyleIndent:
+        return [self indentStyleSize:state->indent
+                             tabStop:state->tabStop
+                         indentToTab:state->indentToTab];
+    case MarkupStyleCenter:
+        return [self centerStyle:state->center];
+    default:
+        return nil;
+    }
+}
+
+// Makes the attributed string for the runs of a chunk, the same as the NSScanner
+// parser would. The fonts, styles, colors and links are only made again when
+// the state changes. colors is from markupColors.
+- (void)appendMarkUpRuns:(const MarkupRunList *)runs
+                   chars:(const unichar *)chars
+                    font:(UIFont *)font
+                  colors:(NSArray *)colors
+                  string:(NSMutableAttributedString *)string {
+    const MarkupState *last = NULL;
+    UIFont *currentFont = nil;
+    NSParagraphStyle *style = nil;
+    UIColor *currentColor = nil;
+    NSString *link = nil;
+
+    for (size_t i = 0; i < runs->count; i++) {
+        @autoreleasepool {
+            const MarkupRun *run = &runs->runs[i];
+            const MarkupState *state = &run->state;
+            ModeAwareColor token = ModeAwareColorForMarkup(state->color);
+
+            if (font != nil && (last == NULL || last->pointSize != state->pointSize ||
+                                last->bold != state->bold || last->italic != state->italic ||
+                                last->fixed != state->fixed)) {
+                UIFont *base = state->fixed ? [UIFont fontWithName:@"Menlo-Bold"
+                                                              size:state->pointSize]
+                                            : font;
+
+                // Without Menlo the parser leaves the font nil, and the text is plain
+                currentFont = base ? [self updateFont:base
+                                            pointSize:state->pointSize
+                                                 bold:state->bold
+                                               italic:state->italic]
+                                   : nil;
+            }
+
+            if (last == NULL || last->style != state->style || last->indent != state->indent ||
+                last->tabStop != state->tabStop || last->indentToTab != state->indentToTab ||
+                last->center != state->center) {
+                style = [self styleForMarkUpState:state];
+            }
+
+            if (last == NULL || last->color != state->color) {
+                id color = colors[state->color < colors.count ? state->color : 'D'];
+                currentColor = (color == [NSNull null]) ? nil : color;
+            }
+
+            if (last == NULL || last->linkStart != state->linkStart ||
+                last->linkLength != state->linkLength) {
+                link = nil;
+
+                if (state->linkLength > 0) {
+                    link = [NSString stringWithCharacters:chars + state->linkStart
+                                                   length:state->linkLength]
+                               .percentDecodeString;
+                }
+            }
+
+            last = state;
+
+            NSString *text = [NSString stringWithCharacters:chars + run->start length:run->length];
+
+            switch (run->kind) {
+            case MarkupRunText:
+                if (run->suffix != 0) {
+                    unichar suffix = run->suffix;
+                    text = [text stringByAppendingString:[NSString stringWithCharacters:&suffix
+                                                                                 length:1]];
+                }
+
+                [text addSegmentToString:currentFont
+                                   style:style
+                                   color:currentColor
+                              colorToken:token
+                                    link:link
+                                  string:string];
+                break;
+
+            case MarkupRunSymbol:
+                if (currentFont) {
+                    NSUInteger start = string.length;
+                    [string appendAttributedString:
+                                [text attributedStringFromNamedSymbolWithFont:currentFont
+                                                                        color:currentColor]];
+
+                    if (token != ModeAwareColorNone) {
+                        [string addAttribute:MarkupColorTokenAttributeName
+                                       value:@(token)
+                                       range:NSMakeRange(start, string.length - start)];
+                    }
+                } else {
+                    [string appendAttributedString:@"?".attributedString];
+                }
+                break;
+
+            case MarkupRunImage:
+                if (currentFont) {
+                    [string appendAttributedString:
+                                [text attributedStringFromImageWithFont:currentFont]];
+                } else {
+                    [string appendAttributedString:@"?".attributedString];
+                }
+                break;
+            }
+        }
+    }
+}
+
+// Splits the markup into chunks and does them at the same time - see
+// MarkupRuns.h. Returns false if it could not, and nothing was added.
+- (bool)appendMarkUpChunks:(size_t)chunks
+                    bounds:(const size_t *)bounds
+                     chars:(const unichar *)chars
+                    length:(size_t)len
+                      font:(UIFont *)font
+                    string:(NSMutableAttributedString *)string {
+    CGFloat pointSize = font ? font.pointSize : 10;
+    NSArray *colors = markupColors();
+    MarkupSummary *summaries = calloc(chunks, sizeof(MarkupSummary));
+    MarkupState *states = malloc(chunks * sizeof(MarkupState));
+    bool *results = malloc(chunks * sizeof(bool));
+    bool ok = (summaries != NULL && states != NULL && results != NULL);
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    if (ok) {
+        dispatch_apply(chunks, queue, ^(size_t k) {
+          results[k] = MarkupSummarize(chars, len, bounds[k], bounds[k + 1], &summaries[k]);
+        });
+
+        MarkupStateInit(&states[0], pointSize);
+
+        for (size_t k = 0; k < chunks; k++) {
+            ok = ok && results[k];
+
+            if (k + 1 < chunks) {
+                states[k + 1] = states[k];
+                MarkupSummaryApply(&summaries[k], &states[k + 1], pointSize);
+            }
+        }
+    }
+
+    if (ok) {
+        NSMutableArray<NSMutableAttributedString *> *parts =
+            [NSMutableArray arrayWithCapacity:chunks];
+
+        for (size_t k = 0; k < chunks; k++) {
+            [parts addObject:[[NSMutableAttributedString alloc] init]];
+        }
+
+        dispatch_apply(chunks, queue, ^(size_t k) {
+          MarkupRunList runs;
+          MarkupState state = states[k];
+
+          MarkupRunListInit(&runs);
+          results[k] =
+              MarkupTokenizeRange(chars, len, bounds[k], bounds[k + 1], pointSize, &state, &runs);
+
+          if (results[k]) {
+              [self appendMarkUpRuns:&runs
+                               chars:chars
+                                font:font
+                              colors:colors
+                              string:parts[k]];
+          }
+
+          MarkupRunListFree(&runs);
+        });
+
+        for (size_t k = 0; k < chunks; k++) {
+            ok = ok && results[k];
+        }
+
+        if (ok) {
+            for (NSMutableAttributedString *part in parts) {
+                [string appendAttributedString:part];
+            }
+        }
+    }
+
+    if (summaries != NULL) {
+        for (size_t k = 0; k < chunks; k++) {
+            MarkupSummaryFree(&summaries[k]);
+        }
+    }
+
+    free(summaries);
+    free(states);
+    free(results);
+
+    return ok;
+}
+
 // See header for formatting markup
 - (NSMutableAttributedString *)attributedStringFromMarkUpWithFont:(UIFont *)font
                                                         fixedFont:(UIFont *)fixedFont {
@@ -285,7 +565,8 @@ static SafeSystemImageBlock safeSystemImage =
     CGFloat currentIndent = 0;
     CGFloat currentTabStop = pointSize;
     bool indentTo2ndTabStop = false;
-    UIColor *currentColor = [UIColor modeAwareText];
+    ModeAwareColor currentToken = ModeAwareColorText;
+    UIColor *currentColor = [UIColor modeAwareColor:currentToken];
     NSString *substring = nil;
     bool italicText = NO;
     bool boldText = NO;
@@ -336,11 +617,19 @@ static SafeSystemImageBlock safeSystemImage =
                     [substring addSegmentToString:currentFont
                                             style:style
                                             color:currentColor
+                                       colorToken:currentToken
                                              link:link
                                            string:string];
                     substring = nil;
                 }
 
+                ModeAwareColor token = ModeAwareColorForMarkup(c);
+
+                if (token != ModeAwareColorNone) {
+                    currentToken = token;
+                    currentColor = [UIColor modeAwareColor:token];
+                }
+
                 switch (c) {
                 default:
                     break;
@@ -392,51 +681,51 @@ static SafeSystemImageBlock safeSystemImage =
                     break;
                 case '0':
                     currentColor = [UIColor blackColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'O':
                     currentColor = [UIColor orangeColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'G':
                     currentColor = [UIColor greenColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'A':
                     currentColor = [UIColor grayColor];
-                    break;
-                case 'K':
-                    currentColor = [UIColor modeAwareGrayText];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'R':
                     currentColor = [UIColor redColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'B':
                     currentColor = [UIColor blueColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'C':
                     currentColor = [UIColor cyanColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'Y':
                     currentColor = [UIColor yellowColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'N':
                     currentColor = [UIColor brownColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'M':
                     currentColor = [UIColor magentaColor];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'W':
                     currentColor = [UIColor whiteColor];
-                    break;
-                case 'D':
-                    currentColor = [UIColor modeAwareText];
-                    break;
-                case '!':
-                    currentColor = [UIColor modeAwareText];
-                    break;
-                case 'U':
-                    currentColor = [UIColor modeAwareBlue];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case 'E':
                     currentColor = [UIColor colorNamed:@"AccentColor"];
+                    currentToken = ModeAwareColorNone;
                     break;
                 case '>': {
                     currentIndent += indent;
@@ -486,7 +775,7 @@ static SafeSystemImageBlock safeSystemImage =
                     [escapeScanner scanUpToString:@" " intoString:&linkScan];
 
                     if (linkScan) {
-                        link = linkScan.stringByRemovingPercentEncoding;
+                        link = linkScan.percentDecodeString;
                     } else {
                         link = nil;
                     }
@@ -510,10 +799,17 @@ static SafeSystemImageBlock safeSystemImage =
                         }
 
                         if (currentFont) {
+                            NSUInteger start = string.length;
                             [string appendAttributedString:
                                         [symbolName
                                             attributedStringFromNamedSymbolWithFont:currentFont
                                                                               color:currentColor]];
+
+                            if (currentToken != ModeAwareColorNone) {
+                                [string addAttribute:MarkupColorTokenAttributeName
+                                               value:@(currentToken)
+                                               range:NSMakeRange(start, string.length - start)];
+                            }
                         } else {
                             [string appendAttributedString:@"?".attributedString];
                         }
@@ -582,6 +878,7 @@ static SafeSystemImageBlock safeSystemImage =
                 [substring addSegmentToString:currentFont
                                         style:style
                                         color:currentColor
+                                   colorToken:currentToken
                                          link:nil
                                        string:string];
                 substring = nil;
@@ -594,6 +891,46 @@ static SafeSystemImageBlock safeSystemImage =
     return string;
 }
 
+// See header for formatting markup
+- (NSMutableAttributedString *)attributedStringFromMarkUpWithFont:(UIFont *)font
+                                                        fixedFont:(UIFont *)fixedFont
+                                                         parallel:(bool)parallel {
+    size_t len = self.length;
+
+    if (!parallel || len < MARKUP_PARALLEL_LENGTH) {
+        return [self attributedStringFromMarkUpWithFont:font fixedFont:fixedFont];
+    }
+
+    NSMutableAttributedString *string = [[NSMutableAttributedString alloc] init];
+    unichar *chars = malloc(len * sizeof(unichar));
+    size_t maxChunks = MAX(NSProcessInfo.processInfo.activeProcessorCount, 1);
+    size_t *bounds = malloc((maxChunks + 1) * sizeof(size_t));
+    bool done = false;
+
+    if (chars != NULL && bounds != NULL) {
+        [self getCharacters:chars range:NSMakeRange(0, len)];
+
+        size_t chunks = MarkupSplitChunks(chars, len, maxChunks, bounds);
+
+        done = chunks >= 2 && [self appendMarkUpChunks:chunks
+                                                bounds:bounds
+                                                 chars:chars
+                                                length:len
+                                                  font:font
+                                                string:string];
+    }
+
+    free(chars);
+    free(bounds);
+
+    if (!done) {
+        // Nowhere to split it, or out of memory
+        return [self attributedStringFromMarkUpWithFont:font fixedFont:fixedFont];
+    }
+
+    return string;
+}
+
 - (NSString *)removeMarkUp {
     return [self attributedStringFromMarkUpWithFont:nil].string;
 }
@@ -689,3 +1026,60 @@ static SafeSystemImageBlock safeSystemImage =
 }
 
 @end
+
+@implementation NSMutableAttributedString (Markup)
+
+- (void)updateMarkupColors {
+    NSRange all = NSMakeRange(0, self.length);
+
+    [self beginEditing];
+
+    [self enumerateAttribute:MarkupColorTokenAttributeName
+                     inRange:all
+                     options:0
+                  usingBlock:^(id value, NSRange range, BOOL *stop) {
+                    if (![value isKindOfClass:[NSNumber class]]) {
+                        return;
+                    }
+
+                    // Anything else would come out as transparent black
+                    int token = ((NSNumber *)value).intValue;
+
+                    if (token <= ModeAwareColorNone || token >= ModeAwareColorCount) {
+                        return;
+                    }
+
+                    UIColor *color = [UIColor modeAwareColor:(ModeAwareColor)token];
+
+                    [self addAttribute:NSForegroundColorAttributeName value:color range:range];
+
+#if !TARGET_OS_WATCH
+                    // SF symbols have the color drawn into the image. Copies of
+                    // the string share the attachment, so it is replaced rather
+                    // than changed.
+                    [self enumerateAttribute:NSAttachmentAttributeName
+                                     inRange:range
+                                     options:0
+                                  usingBlock:^(id attachment, NSRange r, BOOL *stop2) {
+                                    if ([attachment isKindOfClass:[NSTextAttachment class]]) {
+                                        NSTextAttachment *symbol = attachment;
+                                        NSTextAttachment *recolored =
+                                            [[NSTextAttachment alloc] init];
+
+                                        recolored.image = [symbol.image
+                                            imageWithTintColor:color
+                                                 renderingMode:UIImageRenderingModeAlwaysOriginal];
+                                        recolored.bounds = symbol.bounds;
+
+                                        [self addAttribute:NSAttachmentAttributeName
+                                                     value:recolored
+                                                     range:r];
+                                    }
+                                  }];
+#endif // !TARGET_OS_WATCH
+                  }];
+
+    [self endEditing];
+}
+
+@end
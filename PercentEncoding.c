@@ -0,0 +1,230 @@
+//
+//  PercentEncoding.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "PercentEncoding.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SAFE_ALL (PercentEncodeUrlPath | PercentEncodeAlphanumeric)
+#define SAFE_PATH PercentEncodeUrlPath
+#define ASCII_MASK 0x8080808080808080ULL
+
+// One bit per PercentEncodeSet. URLPathAllowedCharacterSet is
+// !$&'()*+,-./0-9:=@A-Z_a-z~
+static const uint8_t safeTable[256] = {
+    ['0'] = SAFE_ALL, ['1'] = SAFE_ALL, ['2'] = SAFE_ALL, ['3'] = SAFE_ALL, ['4'] = SAFE_ALL,
+    ['5'] = SAFE_ALL, ['6'] = SAFE_ALL, ['7'] = SAFE_ALL, ['8'] = SAFE_ALL, ['9'] = SAFE_ALL,
+    ['A'] = SAFE_ALL, ['B'] = SAFE_ALL, ['C'] = SAFE_ALL, ['D'] = SAFE_ALL, ['E'] = SAFE_ALL,
+    ['F'] = SAFE_ALL, ['G'] = SAFE_ALL, ['H'] = SAFE_ALL, ['I'] = SAFE_ALL, ['J'] = SAFE_ALL,
+    ['K'] = SAFE_ALL, ['L'] = SAFE_ALL, ['M'] = SAFE_ALL, ['N'] = SAFE_ALL, ['O'] = SAFE_ALL,
+    ['P'] = SAFE_ALL, ['Q'] = SAFE_ALL, ['R'] = SAFE_ALL, ['S'] = SAFE_ALL, ['T'] = SAFE_ALL,
+    ['U'] = SAFE_ALL, ['V'] = SAFE_ALL, ['W'] = SAFE_ALL, ['X'] = SAFE_ALL, ['Y'] = SAFE_ALL,
+    ['Z'] = SAFE_ALL, ['a'] = SAFE_ALL, ['b'] = SAFE_ALL, ['c'] = SAFE_ALL, ['d'] = SAFE_ALL,
+    ['e'] = SAFE_ALL, ['f'] = SAFE_ALL, ['g'] = SAFE_ALL, ['h'] = SAFE_ALL, ['i'] = SAFE_ALL,
+    ['j'] = SAFE_ALL, ['k'] = SAFE_ALL, ['l'] = SAFE_ALL, ['m'] = SAFE_ALL, ['n'] = SAFE_ALL,
+    ['o'] = SAFE_ALL, ['p'] = SAFE_ALL, ['q'] = SAFE_ALL, ['r'] = SAFE_ALL, ['s'] = SAFE_ALL,
+    ['t'] = SAFE_ALL, ['u'] = SAFE_ALL, ['v'] = SAFE_ALL, ['w'] = SAFE_ALL, ['x'] = SAFE_ALL,
+    ['y'] = SAFE_ALL, ['z'] = SAFE_ALL,
+    ['!'] = SAFE_PATH,
+    ['$'] = SAFE_PATH,
+    ['&'] = SAFE_PATH,
+    ['\''] = SAFE_PATH,
+    ['('] = SAFE_PATH,
+    [')'] = SAFE_PATH,
+    ['*'] = SAFE_PATH,
+    ['+'] = SAFE_PATH,
+    [','] = SAFE_PATH,
+    ['-'] = SAFE_PATH,
+    ['.'] = SAFE_PATH,
+    ['/'] = SAFE_PATH,
+    [':'] = SAFE_PATH,
+    ['='] = SAFE_PATH,
+    ['@'] = SAFE_PATH,
+    ['_'] = SAFE_PATH,
+    ['~'] = SAFE_PATH,
+};
+
+// Hex digit value plus one, so zero means not a hex digit
+static const uint8_t hexTable[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,  ['6'] = 7,  ['7'] = 8,
+    ['8'] = 9,  ['9'] = 10, ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
+
+static const char hexDigits[16] = "0123456789ABCDEF";
+
+void PercentBufferInit(PercentBuffer *buf, char *storage, size_t capacity) {
+    buf->bytes = storage;
+    buf->length = 0;
+    buf->capacity = storage ? capacity : 0;
+    buf->onHeap = false;
+}
+
+void PercentBufferFree(PercentBuffer *buf) {
+    if (buf->onHeap) {
+        free(buf->bytes);
+    }
+    buf->bytes = NULL;
+    buf->length = 0;
+    buf->capacity = 0;
+    buf->onHeap = false;
+}
+
+bool PercentBufferReserve(PercentBuffer *buf, size_t extra) {
+    size_t needed = buf->length + extra;
+
+    if (needed <= buf->capacity) {
+        return true;
+    }
+
+    size_t capacity = buf->capacity ? buf->capacity : 64;
+
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    char *bytes = NULL;
+
+    if (buf->onHeap) {
+        bytes = realloc(buf->bytes, capacity);
+    } else {
+        bytes = malloc(capacity);
+
+        if (bytes && buf->length) {
+            memcpy(bytes, buf->bytes, buf->length);
+        }
+    }
+
+    if (bytes == NULL) {
+        return false;
+    }
+
+    buf->bytes = bytes;
+    buf->capacity = capacity;
+    buf->onHeap = true;
+    return true;
+}
+
+bool PercentBufferAppend(PercentBuffer *buf, const void *bytes, size_t len) {
+    if (!PercentBufferReserve(buf, len)) {
+        return false;
+    }
+
+    if (len) {
+        memcpy(buf->bytes + buf->length, bytes, len);
+        buf->length += len;
+    }
+    return true;
+}
+
+size_t PercentAsciiPrefix(const uint8_t *src, size_t len) {
+    size_t i = 0;
+
+    // Eight bytes at a time until there is a high bit set
+    while (i + sizeof(uint64_t) <= len) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+
+        if (word & ASCII_MASK) {
+            break;
+        }
+        i += sizeof(word);
+    }
+
+    while (i < len && src[i] < 0x80) {
+        i++;
+    }
+
+    return i;
+}
+
+size_t PercentEncodeSafePrefix(const uint8_t *src, size_t len, PercentEncodeSet set) {
+    size_t i = 0;
+
+    // Set is a single bit, so all four bytes are safe if the AND still has it
+    while (i + 4 <= len &&
+           (safeTable[src[i]] & safeTable[src[i + 1]] & safeTable[src[i + 2]] &
+            safeTable[src[i + 3]] & set)) {
+        i += 4;
+    }
+
+    while (i < len && (safeTable[src[i]] & set)) {
+        i++;
+    }
+
+    return i;
+}
+
+bool PercentEncodeAppend(PercentBuffer *buf, const uint8_t *src, size_t len, PercentEncodeSet set) {
+    if (!PercentBufferReserve(buf, len * 3)) {
+        return false;
+    }
+
+    char *out = buf->bytes + buf->length;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = src[i];
+
+        if (safeTable[c] & set) {
+            *out++ = (char)c;
+        } else {
+            *out++ = '%';
+            *out++ = hexDigits[c >> 4];
+            *out++ = hexDigits[c & 0x0F];
+        }
+    }
+
+    buf->length = (size_t)(out - buf->bytes);
+    return true;
+}
+
+bool PercentDecodeAppend(PercentBuffer *buf, const uint8_t *src, size_t len) {
+    if (!PercentBufferReserve(buf, len)) {
+        return false;
+    }
+
+    char *out = buf->bytes + buf->length;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = src[i];
+
+        if (c != '%') {
+            *out++ = (char)c;
+            continue;
+        }
+
+        if (i + 2 >= len) {
+            return false;
+        }
+
+        uint8_t hi = hexTable[src[i + 1]];
+        uint8_t lo = hexTable[src[i + 2]];
+
+        if (hi == 0 || lo == 0) {
+            return false;
+        }
+
+        *out++ = (char)(((hi - 1) << 4) | (lo - 1));
+        i += 2;
+    }
+
+    buf->length = (size_t)(out - buf->bytes);
+    return true;
+}
@@ -0,0 +1,80 @@
+//
+//  PercentEncoding.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plain C percent encoding and decoding of UTF-8 bytes. This is the core of
+// percentEncodeUrl, fullyPercentEncodeString and percentDecodeString in
+// NSString+Convenience, kept free of Foundation so it can be used anywhere.
+
+#ifndef PercentEncoding_h
+#define PercentEncoding_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// The sets of bytes that are left alone. Each is one bit in a shared 256 entry
+// table, so only pass one at a time.
+typedef enum {
+    // Same as the ASCII part of NSCharacterSet.URLPathAllowedCharacterSet
+    PercentEncodeUrlPath = 0x01,
+    // Same as the ASCII part of NSCharacterSet.alphanumericCharacterSet
+    PercentEncodeAlphanumeric = 0x02,
+} PercentEncodeSet;
+
+// A growable output buffer. It can start off using storage provided by the
+// caller (e.g. on the stack) and only moves to the heap if that runs out, so
+// one buffer can be reused for many appends.
+typedef struct {
+    char *bytes;
+    size_t length;
+    size_t capacity;
+    bool onHeap;
+} PercentBuffer;
+
+void PercentBufferInit(PercentBuffer *buf, char *storage, size_t capacity);
+void PercentBufferFree(PercentBuffer *buf);
+bool PercentBufferReserve(PercentBuffer *buf, size_t extra);
+bool PercentBufferAppend(PercentBuffer *buf, const void *bytes, size_t len);
+
+// Number of leading bytes that are below 0x80.
+size_t PercentAsciiPrefix(const uint8_t *src, size_t len);
+
+// Number of leading bytes that do not need to be encoded. If this is len then
+// the input can be used as is.
+size_t PercentEncodeSafePrefix(const uint8_t *src, size_t len, PercentEncodeSet set);
+
+// Appends src to buf, encoding any byte not in set as %XX. Returns false if
+// the buffer could not grow, in which case buf is unchanged.
+bool PercentEncodeAppend(PercentBuffer *buf, const uint8_t *src, size_t len, PercentEncodeSet set);
+
+// Appends src to buf, replacing each %XX with its byte. Returns false if a %
+// is not followed by two hex digits or the buffer could not grow, in which
+// case buf is unchanged. The result is not checked for valid UTF-8.
+bool PercentDecodeAppend(PercentBuffer *buf, const uint8_t *src, size_t len);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !PercentEncoding_h
@@ -0,0 +1,305 @@
+//
+//  SubstringIndex.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SubstringIndex.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIGRAM_KEY(P) (((uint64_t)(P)[0] << 32) | ((uint64_t)(P)[1] << 16) | (uint64_t)(P)[2])
+
+typedef struct {
+    uint64_t key;
+    uint32_t entry;
+} TrigramEntry;
+
+struct SubstringIndex {
+    // All of the strings, back to back. String i is
+    // arena[offsets[i]] .. arena[offsets[i + 1]]
+    uint16_t *arena;
+    size_t *offsets;
+    size_t count;
+
+    // Sorted trigram keys. The strings containing keys[k] are
+    // postings[postingOffsets[k]] .. postings[postingOffsets[k + 1]]
+    uint64_t *keys;
+    size_t *postingOffsets;
+    uint32_t *postings;
+    size_t keyCount;
+};
+
+// The strings to check for a search
+typedef struct {
+    const uint32_t *entries; // NULL for all of them
+    size_t count;
+} Candidates;
+
+static int compareTrigramEntries(const void *a, const void *b) {
+    const TrigramEntry *ta = a;
+    const TrigramEntry *tb = b;
+
+    if (ta->key != tb->key) {
+        return ta->key < tb->key ? -1 : 1;
+    }
+
+    if (ta->entry != tb->entry) {
+        return ta->entry < tb->entry ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static inline bool containsChars(const uint16_t *hay,
+                                 size_t hayLen,
+                                 const uint16_t *needle,
+                                 size_t needleLen) {
+    if (needleLen > hayLen) {
+        return false;
+    }
+
+    const uint16_t first = needle[0];
+    const size_t last = hayLen - needleLen;
+    const size_t rest = (needleLen - 1) * sizeof(uint16_t);
+
+    for (size_t i = 0; i <= last; i++) {
+        if (hay[i] == first && memcmp(hay + i + 1, needle + 1, rest) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline bool entryContains(const SubstringIndex *index,
+                                 size_t entry,
+                                 const uint16_t *needle,
+                                 size_t needleLen) {
+    size_t start = index->offsets[entry];
+    return containsChars(
+        index->arena + start, index->offsets[entry + 1] - start, needle, needleLen);
+}
+
+static bool buildTrigrams(SubstringIndex *index) {
+    size_t trigrams = 0;
+
+    for (size_t i = 0; i < index->count; i++) {
+        size_t len = index->offsets[i + 1] - index->offsets[i];
+
+        if (len >= 3) {
+            trigrams += len - 2;
+        }
+    }
+
+    TrigramEntry *entries = malloc((trigrams > 0 ? trigrams : 1) * sizeof(TrigramEntry));
+    size_t n = 0;
+
+    index->keys = malloc((trigrams > 0 ? trigrams : 1) * sizeof(uint64_t));
+    index->postingOffsets = malloc((trigrams + 1) * sizeof(size_t));
+    index->postings = malloc((trigrams > 0 ? trigrams : 1) * sizeof(uint32_t));
+
+    if (entries == NULL || index->keys == NULL || index->postingOffsets == NULL ||
+        index->postings == NULL) {
+        free(entries);
+        return false;
+    }
+
+    for (size_t i = 0; i < index->count; i++) {
+        const uint16_t *p = index->arena + index->offsets[i];
+        size_t len = index->offsets[i + 1] - index->offsets[i];
+
+        for (size_t j = 0; j + 3 <= len; j++) {
+            entries[n].key = TRIGRAM_KEY(p + j);
+            entries[n].entry = (uint32_t)i;
+            n++;
+        }
+    }
+
+    qsort(entries, n, sizeof(TrigramEntry), compareTrigramEntries);
+
+    size_t keys = 0;
+    size_t postings = 0;
+
+    for (size_t k = 0; k < n; k++) {
+        if (k == 0 || entries[k].key != entries[k - 1].key) {
+            index->keys[keys] = entries[k].key;
+            index->postingOffsets[keys] = postings;
+            keys++;
+            index->postings[postings++] = entries[k].entry;
+        } else if (entries[k].entry != entries[k - 1].entry) {
+            // A trigram repeated in one string is only listed once
+            index->postings[postings++] = entries[k].entry;
+        }
+    }
+
+    index->postingOffsets[keys] = postings;
+    index->keyCount = keys;
+
+    free(entries);
+    return true;
+}
+
+SubstringIndex *SubstringIndexCreate(const uint16_t *chars, const size_t *offsets, size_t count) {
+    if (count > UINT32_MAX) {
+        return NULL;
+    }
+
+    SubstringIndex *index = calloc(1, sizeof(SubstringIndex));
+
+    if (index == NULL) {
+        return NULL;
+    }
+
+    size_t total = offsets[count] - offsets[0];
+
+    index->count = count;
+    index->arena = malloc((total > 0 ? total : 1) * sizeof(uint16_t));
+    index->offsets = malloc((count + 1) * sizeof(size_t));
+
+    if (index->arena == NULL || index->offsets == NULL) {
+        SubstringIndexFree(index);
+        return NULL;
+    }
+
+    if (total > 0) {
+        memcpy(index->arena, chars + offsets[0], total * sizeof(uint16_t));
+    }
+
+    for (size_t i = 0; i <= count; i++) {
+        index->offsets[i] = offsets[i] - offsets[0];
+    }
+
+    if (!buildTrigrams(index)) {
+        SubstringIndexFree(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+void SubstringIndexFree(SubstringIndex *index) {
+    if (index != NULL) {
+        free(index->arena);
+        free(index->offsets);
+        free(index->keys);
+        free(index->postingOffsets);
+        free(index->postings);
+    }
+    free(index);
+}
+
+size_t SubstringIndexCount(const SubstringIndex *index) {
+    return index->count;
+}
+
+// Returns false if the trigram is not in any string
+static bool postingsForKey(const SubstringIndex *index, uint64_t key, Candidates *postings) {
+    size_t lo = 0;
+    size_t hi = index->keyCount;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (index->keys[mid] < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == index->keyCount || index->keys[lo] != key) {
+        return false;
+    }
+
+    postings->entries = index->postings + index->postingOffsets[lo];
+    postings->count = index->postingOffsets[lo + 1] - index->postingOffsets[lo];
+    return true;
+}
+
+// Picks the rarest trigram in the search. Returns false if nothing can match
+// because a trigram is not in the index at all.
+static bool findCandidates(const SubstringIndex *index,
+                           const uint16_t *search,
+                           size_t len,
+                           Candidates *candidates) {
+    candidates->entries = NULL;
+    candidates->count = index->count;
+
+    for (size_t i = 0; i + 3 <= len; i++) {
+        Candidates postings;
+
+        if (!postingsForKey(index, TRIGRAM_KEY(search + i), &postings)) {
+            return false;
+        }
+
+        if (candidates->entries == NULL || postings.count < candidates->count) {
+            *candidates = postings;
+        }
+    }
+
+    return true;
+}
+
+size_t SubstringIndexSearch(const SubstringIndex *index,
+                            const uint16_t *search,
+                            size_t len,
+                            const uint32_t *previous,
+                            size_t previousCount,
+                            uint32_t *matches) {
+    Candidates candidates;
+    size_t found = 0;
+
+    if (len == 0 || !findCandidates(index, search, len, &candidates)) {
+        return 0;
+    }
+
+    if (previous != NULL && (candidates.entries == NULL || previousCount <= candidates.count)) {
+        for (size_t c = 0; c < previousCount && previous[c] < index->count; c++) {
+            if (entryContains(index, previous[c], search, len)) {
+                matches[found++] = previous[c];
+            }
+        }
+    } else if (candidates.entries != NULL) {
+        for (size_t c = 0; c < candidates.count; c++) {
+            if (entryContains(index, candidates.entries[c], search, len)) {
+                matches[found++] = candidates.entries[c];
+            }
+        }
+    } else {
+        // Too short for a trigram, so check everything
+        for (size_t i = 0; i < index->count; i++) {
+            if (entryContains(index, i, search, len)) {
+                matches[found++] = (uint32_t)i;
+            }
+        }
+    }
+
+    return found;
+}
+
+size_t SubstringIndexCandidateCount(const SubstringIndex *index,
+                                    const uint16_t *search,
+                                    size_t len) {
+    Candidates candidates;
+
+    if (len == 0 || !findCandidates(index, search, len, &candidates)) {
+        return 0;
+    }
+
+    return candidates.count;
+}
@@ -0,0 +1,76 @@
+//
+//  SubstringIndex.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plain C substring search over a fixed list of UTF-16 strings, the core of
+// SubstringSearchIndex. The strings are stored back to back in one buffer with
+// a sorted trigram index. A search checks the strings that contain the rarest
+// trigram of the search (or all of them if it is shorter than a trigram)
+// against the stored text.
+//
+// Matching is exact, so fold the strings and the searches the same way first.
+// The index does not change once made, so searches can be done on any thread.
+
+#ifndef SubstringIndex_h
+#define SubstringIndex_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef struct SubstringIndex SubstringIndex;
+
+// String i is chars[offsets[i]] .. chars[offsets[i + 1]], so offsets has
+// count + 1 entries. They are copied. Returns NULL if out of memory or there
+// are too many strings.
+SubstringIndex *SubstringIndexCreate(const uint16_t *chars, const size_t *offsets, size_t count);
+void SubstringIndexFree(SubstringIndex *index);
+
+size_t SubstringIndexCount(const SubstringIndex *index);
+
+// Writes the indices of the strings containing search to matches in ascending
+// order, and returns how many there are. matches must have room for
+// SubstringIndexCount. An empty search matches nothing.
+//
+// previous can be NULL, or the ascending result of a search that is a
+// substring of this one (e.g. before the user typed one more character). Only
+// those strings are checked if there are fewer of them than candidates.
+size_t SubstringIndexSearch(const SubstringIndex *index,
+                            const uint16_t *search,
+                            size_t len,
+                            const uint32_t *previous,
+                            size_t previousCount,
+                            uint32_t *matches);
+
+// The number of strings the search would check without a previous result: the
+// number containing its rarest trigram, 0 if it has a trigram that is not in
+// any string, or all of them if it is too short.
+size_t SubstringIndexCandidateCount(const SubstringIndex *index,
+                                    const uint16_t *search,
+                                    size_t len);
+
+#if defined __cplusplus
+};
+#endif // __cplusplus
+
+#endif // !SubstringIndex_h
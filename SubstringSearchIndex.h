@@ -0,0 +1,63 @@
+//
+//  SubstringSearchIndex.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef void (^SubstringSearchCompletion)(NSString *search, NSIndexSet *indices);
+
+// A prebuilt index for doing hasCaseInsensitiveSubstring: over a large, fixed
+// list of strings (e.g. filtering stop names as the user types).
+//
+// The strings are case and diacritic folded once, and stored back to back in a
+// single buffer (see SubstringIndex.h). A trigram index is used to find the
+// candidates, which are then checked against the folded text. Results are the
+// indices into the original array, in ascending order.
+//
+// As with hasCaseInsensitiveSubstring: an empty search matches nothing.
+//
+// The index is immutable once built, so the synchronous methods can be called
+// from any thread.
+
+@interface SubstringSearchIndex : NSObject
+
++ (instancetype)indexWithStrings:(NSArray<NSString *> *)strings;
+- (instancetype)initWithStrings:(NSArray<NSString *> *)strings;
+- (instancetype)init NS_UNAVAILABLE;
+
+@property (nonatomic, readonly) NSUInteger count;
+
+// Returns the indices of the strings containing search.
+- (NSIndexSet *)indicesMatching:(NSString *)search;
+
+// Narrows a previous result. previous must be the result of a search that
+// is a substring of this one (e.g. the user typed one more character).
+- (NSIndexSet *)indicesMatching:(NSString *)search within:(NSIndexSet *)previous;
+
+// Runs the search on a worker queue and calls completion on the main thread.
+// If another search is started before this one completes, the completion for
+// the older search is not called. When the search contains the previous
+// search the previous result is narrowed rather than starting again.
+- (void)searchAsync:(NSString *)search completion:(SubstringSearchCompletion)completion;
+
+@end
+
+NS_ASSUME_NONNULL_END
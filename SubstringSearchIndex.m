@@ -0,0 +1,195 @@
+//
+//  SubstringSearchIndex.m
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#import "DebugLogging.h"
+#import "SubstringIndex.h"
+#import "SubstringSearchIndex.h"
+#import "TaskDispatch.h"
+#import <stdatomic.h>
+
+#define DEBUG_LEVEL_FOR_FILE LogUI
+
+#define FOLD_OPTIONS (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
+#define STACK_NEEDLE 64
+
+static inline NSString *foldString(NSString *str) {
+    return [str stringByFoldingWithOptions:FOLD_OPTIONS locale:nil];
+}
+
+@implementation SubstringSearchIndex {
+    // The folded strings, see SubstringIndex.h
+    SubstringIndex *_index;
+    NSUInteger _count;
+
+    dispatch_queue_t _queue;
+    atomic_uint_fast64_t _generation;
+
+    // Only touched on _queue
+    NSString *_lastFolded;
+    NSIndexSet *_lastResult;
+}
+
++ (instancetype)indexWithStrings:(NSArray<NSString *> *)strings {
+    return [[[self class] alloc] initWithStrings:strings];
+}
+
+- (instancetype)initWithStrings:(NSArray<NSString *> *)strings {
+    if ((self = [super init])) {
+        NSUInteger count = strings.count;
+        NSMutableArray<NSString *> *folded = [NSMutableArray arrayWithCapacity:count];
+        NSUInteger total = 0;
+
+        for (NSString *str in strings) {
+            NSString *item = foldString(str);
+            [folded addObject:item];
+            total += item.length;
+        }
+
+        unichar *chars = malloc(MAX(total, 1) * sizeof(unichar));
+        size_t *offsets = malloc((count + 1) * sizeof(size_t));
+
+        if (chars != NULL && offsets != NULL) {
+            size_t pos = 0;
+
+            for (NSUInteger i = 0; i < count; i++) {
+                NSString *item = folded[i];
+                NSUInteger len = item.length;
+
+                offsets[i] = pos;
+                [item getCharacters:chars + pos range:NSMakeRange(0, len)];
+                pos += len;
+            }
+
+            offsets[count] = pos;
+            _index = SubstringIndexCreate(chars, offsets, count);
+        }
+
+        free(chars);
+        free(offsets);
+
+        // Without an index nothing matches
+        if (_index == NULL) {
+            ERROR_LOG(@"Out of memory indexing %lu strings\n", (unsigned long)count);
+        }
+
+        _count = _index ? count : 0;
+        _queue = dispatch_queue_create("SubstringSearchIndex", DISPATCH_QUEUE_SERIAL);
+        atomic_init(&_generation, 0);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    SubstringIndexFree(_index);
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (NSIndexSet *)indicesMatchingFolded:(NSString *)folded within:(NSIndexSet *)previous {
+    NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+    NSUInteger len = folded.length;
+
+    if (len == 0 || _count == 0) {
+        return result;
+    }
+
+    unichar stackNeedle[STACK_NEEDLE];
+    unichar *needle = len <= STACK_NEEDLE ? stackNeedle : malloc(len * sizeof(unichar));
+    uint32_t *matches = malloc(_count * sizeof(uint32_t));
+    uint32_t *previousIndices = NULL;
+    __block size_t previousCount = 0;
+
+    if (previous != nil) {
+        previousIndices = malloc(MAX(previous.count, 1) * sizeof(uint32_t));
+
+        [previous enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+          if (idx >= self->_count) {
+              *stop = YES;
+          } else {
+              previousIndices[previousCount++] = (uint32_t)idx;
+          }
+        }];
+    }
+
+    if (needle != NULL && matches != NULL && (previous == nil || previousIndices != NULL)) {
+        [folded getCharacters:needle range:NSMakeRange(0, len)];
+
+        size_t found =
+            SubstringIndexSearch(_index, needle, len, previousIndices, previousCount, matches);
+
+        for (size_t i = 0; i < found; i++) {
+            [result addIndex:matches[i]];
+        }
+    } else {
+        ERROR_LOG(@"Out of memory searching %lu strings\n", (unsigned long)_count);
+    }
+
+    if (needle != stackNeedle) {
+        free(needle);
+    }
+
+    free(matches);
+    free(previousIndices);
+
+    return result;
+}
+
+- (NSIndexSet *)indicesMatching:(NSString *)search {
+    return [self indicesMatchingFolded:foldString(search) within:nil];
+}
+
+- (NSIndexSet *)indicesMatching:(NSString *)search within:(NSIndexSet *)previous {
+    return [self indicesMatchingFolded:foldString(search) within:previous];
+}
+
+- (void)searchAsync:(NSString *)search completion:(SubstringSearchCompletion)completion {
+    uint64_t generation = atomic_fetch_add(&_generation, 1) + 1;
+    NSString *searchCopy = search.copy;
+
+    dispatch_async(_queue, ^{
+      // Skip it if the user has already typed something else
+      if (atomic_load(&self->_generation) != generation) {
+          return;
+      }
+
+      NSString *folded = foldString(searchCopy);
+      NSIndexSet *previous = nil;
+
+      if (self->_lastResult != nil && self->_lastFolded.length > 0 &&
+          [folded containsString:self->_lastFolded]) {
+          previous = self->_lastResult;
+      }
+
+      NSIndexSet *result = [self indicesMatchingFolded:folded within:previous];
+
+      self->_lastFolded = folded;
+      self->_lastResult = result;
+
+      MAIN_TASK(^{
+        if (atomic_load(&self->_generation) == generation) {
+            completion(searchCopy, result);
+        }
+      });
+    });
+}
+
+@end
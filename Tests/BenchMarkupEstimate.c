@@ -0,0 +1,125 @@
+//
+//  BenchMarkupEstimate.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Time to estimate the height of a table row from its markup, with a cheap
+// stub metrics provider. It is timed with a new metrics cache for every row,
+// as if the estimator were not kept around, and with one cache for all of
+// them. A real provider costs much more per character than the stub, so the
+// difference on a device is bigger.
+//
+// A full render (attributedStringFromMarkUpWithFont: and boundingRectWithSize:)
+// needs UIKit, so compare against it on a device with the same rows.
+
+#include "MarkupEstimate.h"
+#include "TestCommon.h"
+#include <string.h>
+
+#define ROUNDS 20000
+#define ROW_WIDTH 320.0
+
+static const char *rows[] = {
+    "#bSW 5th & Oak St MAX Station#b#n#AStop ID 8989#D",
+    "#b#RMAX Red Line#D#b to Portland Int'l Airport#n#>Every 15 minutes#<",
+    "#Sexclamationmark.triangle.fill #!Service alert: shuttle buses replace trains between "
+    "Gateway and Rose Quarter while the bridge is repaired. Allow extra time.#D",
+    "#(Departs#t#b12:45#b#tin 3 min#n#Sbus #UNo 20 Burnside/Stark#D#)",
+    "#LMAX%20Map Show on the map#T#n#~#>#2Platform 1#tTowards City Center#tLow floor",
+};
+
+#define ROWS (sizeof(rows) / sizeof(rows[0]))
+
+static volatile double sink = 0;
+
+static double stubAdvance(void *context, MarkupFontKey font, uint16_t c) {
+    (void)context;
+
+    // Something for the compiler not to throw away
+    double width = font.pointSize * (0.45 + (double)(c % 7) * 0.03);
+    return font.bold ? width * 1.05 : width;
+}
+
+static double stubLineHeight(void *context, MarkupFontKey font) {
+    (void)context;
+    return font.pointSize * 1.2;
+}
+
+static double stubAttachmentWidth(void *context, MarkupFontKey font) {
+    (void)context;
+    return font.pointSize;
+}
+
+typedef struct {
+    uint16_t chars[512];
+    size_t len;
+} Row;
+
+static double timeRows(const Row *markup, MarkupMetricsCache *cache, bool fresh) {
+    MarkupMetrics metrics = {NULL, stubAdvance, stubLineHeight, stubAttachmentWidth};
+    double start = testSeconds();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < ROWS; i++) {
+            MarkupMetricsCache *rowCache = fresh ? MarkupMetricsCacheCreate(&metrics) : cache;
+            MarkupRunList runs;
+
+            MarkupRunListInit(&runs);
+
+            if (rowCache != NULL && MarkupTokenize(markup[i].chars, markup[i].len, 12, &runs)) {
+                sink += MarkupEstimateHeight(markup[i].chars, &runs, ROW_WIDTH, rowCache);
+            }
+
+            MarkupRunListFree(&runs);
+
+            if (fresh) {
+                MarkupMetricsCacheFree(rowCache);
+            }
+        }
+    }
+
+    return (testSeconds() - start) / (ROUNDS * ROWS) * 1e6;
+}
+
+int main(void) {
+    static Row markup[ROWS];
+    MarkupMetrics metrics = {NULL, stubAdvance, stubLineHeight, stubAttachmentWidth};
+    MarkupMetricsCache *cache = MarkupMetricsCacheCreate(&metrics);
+
+    if (cache == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < ROWS; i++) {
+        markup[i].len = strlen(rows[i]);
+
+        for (size_t c = 0; c < markup[i].len; c++) {
+            markup[i].chars[c] = (uint8_t)rows[i][c];
+        }
+    }
+
+    double uncached = timeRows(markup, NULL, true);
+    double cached = timeRows(markup, cache, false);
+
+    printf("markup height estimate, %d rows\n", (int)(ROUNDS * ROWS));
+    printf("  new cache per row  %8.2f us/row\n", uncached);
+    printf("  shared cache       %8.2f us/row  %.1fx\n", cached, uncached / cached);
+
+    MarkupMetricsCacheFree(cache);
+    return 0;
+}
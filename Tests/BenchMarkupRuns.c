@@ -0,0 +1,223 @@
+//
+//  BenchMarkupRuns.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Times tokenizing a large markup document in 1 to 16 chunks, one thread each,
+// the same way the parallel path in NSString+Markup does with dispatch_apply:
+// summarize the chunks in parallel, apply the summaries in order, tokenize the
+// chunks in parallel and join the runs. Scaling stops at the number of cores.
+//
+//   BenchMarkupRuns [max chunks] [size in KB]
+
+#include "MarkupRuns.h"
+#include "TestCommon.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_CHUNKS 64
+#define POINT_SIZE 12.0
+#define REPEATS 10
+
+// A service alerts digest is many of these
+static const char *alert =
+    "#b#RMAX Red Line#D#b #Sexclamationmark.triangle.fill #n"
+    "#>Shuttle buses replace trains between Gateway and Rose Quarter while the bridge is "
+    "repaired. #iAllow an extra 20 minutes#i for your trip. #LMAX%20Map Details#T #n"
+    "#<#AUpdated 12:45 PM#D #n#n";
+
+typedef struct {
+    const uint16_t *chars;
+    size_t len;
+    size_t start;
+    size_t end;
+    MarkupState state;
+    MarkupSummary summary;
+    MarkupRunList runs;
+    bool ok;
+} Chunk;
+
+static void *summarizeChunk(void *arg) {
+    Chunk *chunk = arg;
+    chunk->ok = MarkupSummarize(chunk->chars,
+                                chunk->len,
+                                chunk->start,
+                                chunk->end,
+                                &chunk->summary);
+    return NULL;
+}
+
+static void *tokenizeChunk(void *arg) {
+    Chunk *chunk = arg;
+    chunk->ok = MarkupTokenizeRange(chunk->chars,
+                                    chunk->len,
+                                    chunk->start,
+                                    chunk->end,
+                                    POINT_SIZE,
+                                    &chunk->state,
+                                    &chunk->runs);
+    return NULL;
+}
+
+static bool runThreads(Chunk *chunks, size_t count, void *(*work)(void *)) {
+    pthread_t threads[MAX_CHUNKS];
+    bool ok = true;
+
+    // The first chunk is done on this thread, as dispatch_apply does
+    for (size_t k = 1; k < count; k++) {
+        ok = ok && pthread_create(&threads[k], NULL, work, &chunks[k]) == 0;
+    }
+
+    work(&chunks[0]);
+
+    for (size_t k = 1; k < count; k++) {
+        pthread_join(threads[k], NULL);
+        ok = ok && chunks[k].ok;
+    }
+
+    return ok && chunks[0].ok;
+}
+
+// Returns the number of runs, or 0 if it failed
+static size_t parallelTokenize(const uint16_t *chars, size_t len, size_t maxChunks) {
+    static Chunk chunks[MAX_CHUNKS];
+    size_t bounds[MAX_CHUNKS + 1];
+    size_t count = MarkupSplitChunks(chars, len, maxChunks, bounds);
+    MarkupRunList joined;
+    bool ok = true;
+
+    MarkupRunListInit(&joined);
+
+    for (size_t k = 0; k < count; k++) {
+        chunks[k].chars = chars;
+        chunks[k].len = len;
+        chunks[k].start = bounds[k];
+        chunks[k].end = bounds[k + 1];
+        MarkupSummaryInit(&chunks[k].summary);
+        MarkupRunListInit(&chunks[k].runs);
+    }
+
+    ok = runThreads(chunks, count, summarizeChunk);
+
+    MarkupStateInit(&chunks[0].state, POINT_SIZE);
+
+    for (size_t k = 1; k < count; k++) {
+        chunks[k].state = chunks[k - 1].state;
+        MarkupSummaryApply(&chunks[k - 1].summary, &chunks[k].state, POINT_SIZE);
+    }
+
+    ok = ok && runThreads(chunks, count, tokenizeChunk);
+
+    // Join the runs into one list
+    size_t total = 0;
+
+    for (size_t k = 0; k < count; k++) {
+        total += chunks[k].runs.count;
+    }
+
+    joined.runs = malloc(total * sizeof(MarkupRun));
+    ok = ok && joined.runs != NULL;
+
+    for (size_t k = 0; ok && k < count; k++) {
+        memcpy(joined.runs + joined.count,
+               chunks[k].runs.runs,
+               chunks[k].runs.count * sizeof(MarkupRun));
+        joined.count += chunks[k].runs.count;
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        MarkupSummaryFree(&chunks[k].summary);
+        MarkupRunListFree(&chunks[k].runs);
+    }
+
+    size_t runs = ok ? joined.count : 0;
+    MarkupRunListFree(&joined);
+    return runs;
+}
+
+int main(int argc, char *argv[]) {
+    size_t maxChunks = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    size_t kb = argc > 2 ? strtoul(argv[2], NULL, 10) : 300;
+
+    if (maxChunks < 1 || maxChunks > MAX_CHUNKS) {
+        maxChunks = 16;
+    }
+
+    size_t alertLen = strlen(alert);
+    size_t len = kb * 1024 / sizeof(uint16_t);
+    uint16_t *chars = malloc(len * sizeof(uint16_t));
+
+    if (chars == NULL) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)alert[i % alertLen];
+    }
+
+    double sequential = 1e9;
+    size_t expectedRuns = 0;
+
+    for (int r = 0; r < REPEATS; r++) {
+        MarkupRunList runs;
+        MarkupRunListInit(&runs);
+
+        double start = testSeconds();
+        MarkupTokenize(chars, len, POINT_SIZE, &runs);
+        double time = testSeconds() - start;
+
+        if (time < sequential) {
+            sequential = time;
+        }
+
+        expectedRuns = runs.count;
+        MarkupRunListFree(&runs);
+    }
+
+    printf("markup tokenize, %zu KB, %zu runs, %ld cores online\n",
+           kb,
+           expectedRuns,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  sequential  %8.3f ms\n", sequential * 1e3);
+
+    for (size_t chunks = 1; chunks <= maxChunks; chunks++) {
+        double best = 1e9;
+        size_t runs = 0;
+
+        for (int r = 0; r < REPEATS; r++) {
+            double start = testSeconds();
+            runs = parallelTokenize(chars, len, chunks);
+            double time = testSeconds() - start;
+
+            if (time < best) {
+                best = time;
+            }
+        }
+
+        printf("  %2zu chunks   %8.3f ms  %5.2fx%s\n",
+               chunks,
+               best * 1e3,
+               sequential / best,
+               runs == expectedRuns ? "" : "  WRONG NUMBER OF RUNS");
+    }
+
+    free(chars);
+    return 0;
+}
@@ -0,0 +1,113 @@
+//
+//  BenchPercentEncoding.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the table encoder with a simple one that looks each byte up in a
+// string of allowed characters and formats escapes with snprintf, for the sort
+// of components that go into our query URLs.
+
+#include "PercentEncoding.h"
+#include "TestCommon.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ALLOWED "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+#define ROUNDS 200000
+
+static const char *components[] = {
+    "8989",
+    "MAX Red Line to Portland Int'l Airport",
+    "SW 5th & Oak St MAX Station",
+    "Caf\xC3\xA9 Stra\xC3\x9F"
+    "e",
+    "0123456789abcdef0123456789abcdef",
+};
+
+#define COMPONENTS (sizeof(components) / sizeof(components[0]))
+
+static size_t naiveEncode(char *out, const uint8_t *src, size_t len) {
+    char *start = out;
+
+    for (size_t i = 0; i < len; i++) {
+        if (src[i] != 0 && strchr(ALLOWED, src[i]) != NULL) {
+            *out++ = (char)src[i];
+        } else {
+            out += snprintf(out, 4, "%%%02X", src[i]);
+        }
+    }
+
+    return (size_t)(out - start);
+}
+
+int main(void) {
+    size_t lengths[COMPONENTS];
+    size_t bytes = 0;
+    size_t check = 0;
+    char out[512];
+
+    for (size_t c = 0; c < COMPONENTS; c++) {
+        lengths[c] = strlen(components[c]);
+        bytes += lengths[c];
+    }
+
+    double start = testSeconds();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t c = 0; c < COMPONENTS; c++) {
+            check += naiveEncode(out, (const uint8_t *)components[c], lengths[c]);
+        }
+    }
+
+    double naive = testSeconds() - start;
+
+    // One buffer reused for the whole URL, as urlString:withQueryItems: does
+    PercentBuffer buf;
+    PercentBufferInit(&buf, out, sizeof(out));
+
+    start = testSeconds();
+
+    for (int r = 0; r < ROUNDS; r++) {
+        buf.length = 0;
+
+        for (size_t c = 0; c < COMPONENTS; c++) {
+            const uint8_t *src = (const uint8_t *)components[c];
+
+            if (PercentEncodeSafePrefix(src, lengths[c], PercentEncodeAlphanumeric) ==
+                lengths[c]) {
+                PercentBufferAppend(&buf, src, lengths[c]);
+            } else {
+                PercentEncodeAppend(&buf, src, lengths[c], PercentEncodeAlphanumeric);
+            }
+        }
+
+        check += buf.length;
+    }
+
+    double table = testSeconds() - start;
+
+    PercentBufferFree(&buf);
+
+    double mb = (double)bytes * ROUNDS / 1e6;
+
+    printf("percent encode %.1f MB of components (check %zu)\n", mb, check);
+    printf("  naive  %8.1f MB/s\n", mb / naive);
+    printf("  table  %8.1f MB/s  %.1fx\n", mb / table, naive / table);
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+//
+//  BenchSubstringSearchIndex.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Time to filter a list of stop names as each character of a search is typed,
+// with SubstringIndex (the core of SubstringSearchIndex) on its own and
+// narrowing the last result, and with a scan of every name as
+// hasCaseInsensitiveSubstring: would do. The names are already folded, as
+// SubstringSearchIndex folds them first, so the scan is faster here than it
+// is in the app.
+//
+//   BenchSubstringSearchIndex [number of names]
+
+#include "SubstringIndex.h"
+#include "TestCommon.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 20
+
+static const char *streets[] = {
+    "burnside", "stark",     "oak",       "pine",      "ash",       "ankeny",   "couch",
+    "davis",    "everett",   "flanders",  "glisan",    "hoyt",      "irving",   "johnson",
+    "kearney",  "lovejoy",   "marshall",  "northrup",  "overton",   "pettygrove",
+    "quimby",   "raleigh",   "savier",    "thurman",   "upshur",    "vaughn",   "wilson",
+    "york",     "broadway",  "sandy",     "powell",    "division",  "hawthorne",
+    "belmont",  "morrison",  "yamhill",   "taylor",    "salmon",    "madison",  "jefferson",
+    "columbia", "clay",      "market",    "mill",      "montgomery", "harrison", "lincoln",
+    "grant",    "sheridan",  "caruthers", "woodstock", "holgate",   "foster",   "killingsworth",
+};
+
+static const char *kinds[] = {"st", "ave", "blvd", "rd", "dr", "way", "ct", "pl", "hwy"};
+
+static const char *searches[] = {"burnside", "12th ave", "max station", "lovejoy & 2",
+                                 "zzz",      "ave",      "foster rd",   "transit center"};
+
+#define COUNT(A) (sizeof(A) / sizeof((A)[0]))
+
+static volatile size_t sink = 0;
+
+static size_t appendAscii(uint16_t *chars, const char *str) {
+    size_t len = strlen(str);
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)str[i];
+    }
+
+    return len;
+}
+
+// e.g. "burnside st & 12th ave" or "glisan transit center"
+static size_t randomName(uint64_t *seed, uint16_t *chars) {
+    char name[128];
+    const char *first = streets[testRandomBelow(seed, COUNT(streets))];
+    const char *kind = kinds[testRandomBelow(seed, COUNT(kinds))];
+
+    switch (testRandomBelow(seed, 4)) {
+    case 0:
+        snprintf(name,
+                 sizeof(name),
+                 "%s %s & %uth ave",
+                 first,
+                 kind,
+                 (unsigned)(2 + testRandomBelow(seed, 180)));
+        break;
+    case 1:
+        snprintf(name,
+                 sizeof(name),
+                 "%s %s & %s %s",
+                 first,
+                 kind,
+                 streets[testRandomBelow(seed, COUNT(streets))],
+                 kinds[testRandomBelow(seed, COUNT(kinds))]);
+        break;
+    case 2:
+        snprintf(name, sizeof(name), "%s transit center", first);
+        break;
+    default:
+        snprintf(name, sizeof(name), "%s/%s max station", first, kind);
+        break;
+    }
+
+    return appendAscii(chars, name);
+}
+
+static size_t scanSearch(const uint16_t *chars,
+                         const size_t *offsets,
+                         size_t count,
+                         const uint16_t *search,
+                         size_t len,
+                         uint32_t *matches) {
+    size_t found = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const uint16_t *hay = chars + offsets[i];
+        size_t hayLen = offsets[i + 1] - offsets[i];
+
+        for (size_t start = 0; start + len <= hayLen; start++) {
+            if (memcmp(hay + start, search, len * sizeof(uint16_t)) == 0) {
+                matches[found++] = (uint32_t)i;
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+typedef enum { Scan, Index, Narrowed } Method;
+
+// Microseconds per keystroke, typing each search one character at a time.
+// worst is the slowest keystroke.
+static double timeTyping(const SubstringIndex *index,
+                         const uint16_t *chars,
+                         const size_t *offsets,
+                         size_t count,
+                         Method method,
+                         uint32_t *matches,
+                         uint32_t *previous,
+                         double *worst) {
+    size_t keystrokes = 0;
+    double total = 0;
+
+    *worst = 0;
+
+    for (size_t s = 0; s < COUNT(searches); s++) {
+        uint16_t search[64];
+        size_t searchLen = appendAscii(search, searches[s]);
+        size_t previousCount = 0;
+
+        for (size_t len = 1; len <= searchLen; len++) {
+            double start = testSeconds();
+            size_t found = 0;
+
+            for (int r = 0; r < ROUNDS; r++) {
+                switch (method) {
+                case Scan:
+                    found = scanSearch(chars, offsets, count, search, len, matches);
+                    break;
+                case Index:
+                    found = SubstringIndexSearch(index, search, len, NULL, 0, matches);
+                    break;
+                case Narrowed:
+                    found = SubstringIndexSearch(
+                        index, search, len, len > 1 ? previous : NULL, previousCount, matches);
+                    break;
+                }
+
+                sink += found;
+            }
+
+            double time = (testSeconds() - start) / ROUNDS * 1e6;
+
+            if (method == Narrowed) {
+                memcpy(previous, matches, found * sizeof(uint32_t));
+                previousCount = found;
+            }
+
+            if (time > *worst) {
+                *worst = time;
+            }
+
+            total += time;
+            keystrokes++;
+        }
+    }
+
+    return total / (double)keystrokes;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    uint16_t *chars = malloc(count * 128 * sizeof(uint16_t));
+    size_t *offsets = malloc((count + 1) * sizeof(size_t));
+    uint32_t *matches = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    uint32_t *previous = malloc((count > 0 ? count : 1) * sizeof(uint32_t));
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+
+    if (chars == NULL || offsets == NULL || matches == NULL || previous == NULL) {
+        return 1;
+    }
+
+    offsets[0] = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        offsets[i + 1] = offsets[i] + randomName(&seed, chars + offsets[i]);
+    }
+
+    double start = testSeconds();
+    SubstringIndex *index = SubstringIndexCreate(chars, offsets, count);
+    double build = testSeconds() - start;
+
+    if (index == NULL) {
+        return 1;
+    }
+
+    double scanWorst = 0;
+    double indexedWorst = 0;
+    double narrowedWorst = 0;
+    double scan = timeTyping(index, chars, offsets, count, Scan, matches, previous, &scanWorst);
+    double indexed =
+        timeTyping(index, chars, offsets, count, Index, matches, previous, &indexedWorst);
+    double narrowed =
+        timeTyping(index, chars, offsets, count, Narrowed, matches, previous, &narrowedWorst);
+
+    printf("substring search, %zu names, index built in %.1f ms\n", count, build * 1e3);
+    printf("                   us/keystroke    worst\n");
+    printf("  scan every name  %8.1f       %8.1f\n", scan, scanWorst);
+    printf("  index            %8.1f       %8.1f  %5.1fx\n", indexed, indexedWorst, scan / indexed);
+    printf("  index, narrowed  %8.1f       %8.1f  %5.1fx\n",
+           narrowed,
+           narrowedWorst,
+           scan / narrowed);
+
+    SubstringIndexFree(index);
+    free(chars);
+    free(offsets);
+    free(matches);
+    free(previous);
+    return 0;
+}
@@ -0,0 +1,67 @@
+//
+//  TestCommon.h
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Just enough for the plain C tests and benchmarks - each test is a program
+// that returns non-zero if any CHECK failed.
+
+#ifndef TestCommon_h
+#define TestCommon_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Not used by the benchmarks
+static int testFailures __attribute__((unused)) = 0;
+
+#define CHECK(COND)                                                                                \
+    do {                                                                                           \
+        if (!(COND)) {                                                                             \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #COND);               \
+            testFailures++;                                                                        \
+        }                                                                                          \
+    } while (0)
+
+#define TEST_RESULT()                                                                              \
+    (testFailures == 0 ? (printf("%s passed\n", __FILE__), 0)                                      \
+                       : (fprintf(stderr, "%s: %d failed\n", __FILE__, testFailures), 1))
+
+// Small repeatable random numbers (xorshift64), so failures can be reproduced
+static inline uint64_t testRandom(uint64_t *seed) {
+    uint64_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *seed = x;
+    return x;
+}
+
+static inline uint32_t testRandomBelow(uint64_t *seed, uint32_t limit) {
+    return (uint32_t)(testRandom(seed) % limit);
+}
+
+static inline double testSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+#endif // !TestCommon_h
@@ -0,0 +1,175 @@
+//
+//  TestHexColor.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "HexColor.h"
+#include "TestCommon.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool parse8(const char *str, uint32_t *rgba) {
+    return HexColorParseUTF8(str, strlen(str), rgba);
+}
+
+static bool parse16(const char *str, uint32_t *rgba) {
+    uint16_t chars[64];
+    size_t len = strlen(str);
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)str[i];
+    }
+
+    return HexColorParseUTF16(chars, len, rgba);
+}
+
+static bool parsesTo(const char *str, uint32_t expected) {
+    uint32_t rgba8 = 0;
+    uint32_t rgba16 = 0;
+
+    return parse8(str, &rgba8) && rgba8 == expected && parse16(str, &rgba16) &&
+           rgba16 == expected;
+}
+
+static bool rejects(const char *str) {
+    uint32_t rgba = 0x12345678;
+
+    return !parse8(str, &rgba) && !parse16(str, &rgba);
+}
+
+// Format then parse every RGBA value whose top four bits are top, in UTF-8 and
+// UTF-16. There are four billion colors so this is split up to be run in
+// parallel. Counts failures rather than CHECKing each one so a bug does not
+// print millions of lines.
+static void testEveryColor(uint32_t top) {
+    uint64_t failures = 0;
+    char hex[HEX_COLOR_MAX_CHARS];
+    uint16_t hex16[HEX_COLOR_MAX_CHARS];
+
+    for (uint32_t low = 0; low < (1u << 28); low++) {
+        uint32_t rgba = (top << 28) | low;
+        uint32_t parsed8 = ~rgba;
+        uint32_t parsed16 = ~rgba;
+        size_t len = HexColorFormat(rgba, hex);
+
+        for (size_t i = 0; i < len; i++) {
+            hex16[i] = (uint8_t)hex[i];
+        }
+
+        if (len != 9 || hex[9] != 0 || !HexColorParseUTF8(hex, len, &parsed8) ||
+            parsed8 != rgba || !HexColorParseUTF16(hex16, len, &parsed16) || parsed16 != rgba) {
+            failures++;
+        }
+    }
+
+    CHECK(failures == 0);
+}
+
+static void testFormat(void) {
+    char hex[HEX_COLOR_MAX_CHARS];
+
+    CHECK(HexColorFormat(0x00000000, hex) == 9 && strcmp(hex, "#00000000") == 0);
+    CHECK(HexColorFormat(0x0A1B2C3D, hex) == 9 && strcmp(hex, "#0A1B2C3D") == 0);
+    CHECK(HexColorFormat(0xFFFFFFFF, hex) == 9 && strcmp(hex, "#FFFFFFFF") == 0);
+}
+
+static void testForms(void) {
+    // Six digits are opaque
+    CHECK(parsesTo("#0A1B2C", 0x0A1B2CFF));
+    CHECK(parsesTo("0A1B2C", 0x0A1B2CFF));
+    CHECK(parsesTo("#0A1B2C3D", 0x0A1B2C3D));
+    CHECK(parsesTo("0A1B2C3D", 0x0A1B2C3D));
+
+    // Either case
+    CHECK(parsesTo("#abcdef", 0xABCDEFFF));
+    CHECK(parsesTo("#AbCdEf01", 0xABCDEF01));
+
+    // Whitespace
+    CHECK(parsesTo("  #abcdef", 0xABCDEFFF));
+    CHECK(parsesTo("#abcdef \t\n", 0xABCDEFFF));
+    CHECK(parsesTo("\r\n abcdef12\v\f", 0xABCDEF12));
+
+    CHECK(HEX_COLOR_OPAQUE(0x123456) == 0x123456FF);
+    CHECK(HEX_COLOR_RGBA(0x123456, 0x78) == 0x12345678);
+}
+
+static void testUnicodeSpace(void) {
+    // Non-breaking space and ideographic space around "#ABCDEF"
+    static const uint16_t wide[] = {0x00A0, '#', 'A', 'B', 'C', 'D', 'E', 'F', 0x3000};
+    uint32_t rgba = 0;
+
+    CHECK(HexColorParseUTF16(wide, sizeof(wide) / sizeof(wide[0]), &rgba) && rgba == 0xABCDEFFF);
+
+    // Characters that become hex digits if only the low byte is looked at
+    static const uint16_t high[] = {'#', 'A', 'B', 'C', 'D', 'E', 0x0146};
+
+    CHECK(!HexColorParseUTF16(high, sizeof(high) / sizeof(high[0]), &rgba));
+
+    // UTF-8 only skips ASCII whitespace, so a UTF-8 NBSP is not a color
+    CHECK(!parse8("\xC2\xA0#ABCDEF", &rgba));
+}
+
+static void testRejects(void) {
+    // Bad lengths
+    CHECK(rejects(""));
+    CHECK(rejects("#"));
+    CHECK(rejects("   "));
+    CHECK(rejects("#ABC"));
+    CHECK(rejects("#ABCD"));
+    CHECK(rejects("#ABCDE"));
+    CHECK(rejects("#ABCDEF0"));
+    CHECK(rejects("#ABCDEF012"));
+    CHECK(rejects("ABCDEF0123"));
+
+    // Not hex
+    CHECK(rejects("#ABCDEG"));
+    CHECK(rejects("#GBCDEF"));
+    CHECK(rejects("#ABCDEF0g"));
+    CHECK(rejects("#AB DEF"));
+    CHECK(rejects("##ABCDEF"));
+    CHECK(rejects("#-BCDEF"));
+    CHECK(rejects("0xABCDEF"));
+
+    // Every character that is not a hex digit, in every position
+    for (int c = 0; c < 256; c++) {
+        bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+
+        for (int pos = 1; pos <= 6 && !hex; pos++) {
+            char str[8] = "#123456";
+            uint32_t rgba = 0;
+
+            str[pos] = (char)c;
+            CHECK(!HexColorParseUTF8(str, 7, &rgba));
+        }
+    }
+}
+
+// With an argument of 0 to 15 only that part of testEveryColor is run
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        testEveryColor((uint32_t)strtoul(argv[1], NULL, 10) & 0xF);
+        return TEST_RESULT();
+    }
+
+    testFormat();
+    testForms();
+    testUnicodeSpace();
+    testRejects();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,187 @@
+//
+//  TestMarkupEstimate.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MarkupEstimate.h"
+#include "TestCommon.h"
+#include <string.h>
+
+// With the stub metrics every character is as wide as the point size (two more
+// if bold), lines are two points taller than the point size and attachments
+// are 25 wide. The markup starts at 10 points, so plain characters are 10 wide
+// and lines are 12 high.
+#define LINE 12.0
+
+static size_t advanceCalls = 0;
+
+static double stubAdvance(void *context, MarkupFontKey font, uint16_t c) {
+    (void)context;
+    (void)c;
+    advanceCalls++;
+    return font.pointSize + (font.bold ? 2 : 0);
+}
+
+static double stubLineHeight(void *context, MarkupFontKey font) {
+    (void)context;
+    return font.pointSize + 2;
+}
+
+static double stubAttachmentWidth(void *context, MarkupFontKey font) {
+    (void)context;
+    (void)font;
+    return 25;
+}
+
+static MarkupMetricsCache *cache = NULL;
+
+static double heightOf16(const uint16_t *chars, size_t len, double width) {
+    MarkupRunList runs;
+    double height = -1;
+
+    MarkupRunListInit(&runs);
+
+    if (MarkupTokenize(chars, len, 10, &runs)) {
+        height = MarkupEstimateHeight(chars, &runs, width, cache);
+    }
+
+    MarkupRunListFree(&runs);
+    return height;
+}
+
+static double heightOf(const char *markup, double width) {
+    uint16_t chars[256];
+    size_t len = strlen(markup);
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)markup[i];
+    }
+
+    return heightOf16(chars, len, width);
+}
+
+static void testLines(void) {
+    CHECK(heightOf("", 100) == 0);
+    CHECK(heightOf("hello", 1000) == LINE);
+
+    // Five characters exactly fill 50, a sixth goes on the next line
+    CHECK(heightOf("aaaaa", 50) == LINE);
+    CHECK(heightOf("aaaaaa", 50) == 2 * LINE);
+
+    // A word too long for a line is broken up
+    CHECK(heightOf("aaaaaaaaaaaa", 50) == 3 * LINE);
+
+    // Words move down whole, and spaces can hang off the end of a line
+    CHECK(heightOf("aaa bbb", 70) == LINE);
+    CHECK(heightOf("aaa bbb", 60) == 2 * LINE);
+    CHECK(heightOf("aaaaa bbbbb", 50) == 2 * LINE);
+
+    // Bigger and bold text
+    CHECK(heightOf("a#]b", 1000) == 16);
+    CHECK(heightOf("#baaaa", 50) == LINE);
+    CHECK(heightOf("#baaaaa", 50) == 2 * LINE);
+}
+
+static void testNewLines(void) {
+    CHECK(heightOf("a#nb#nc", 1000) == 3 * LINE);
+
+    // A trailing new line does not add a line, but an empty one in the middle does
+    CHECK(heightOf("a#n", 1000) == LINE);
+    CHECK(heightOf("a#n#nb", 1000) == 3 * LINE);
+
+    // Each paragraph wraps on its own
+    CHECK(heightOf("aaaaaa#naaaaaa", 50) == 4 * LINE);
+}
+
+static void testIndents(void) {
+    // #> indents the wrapped lines by the point size, not the first one
+    CHECK(heightOf("aaaaaaaaaa", 50) == 2 * LINE);
+    CHECK(heightOf("#>aaaaaaaaa", 50) == 2 * LINE);
+    CHECK(heightOf("#>aaaaaaaaaa", 50) == 3 * LINE);
+    CHECK(heightOf("#>#>aaaaaaaa", 50) == 2 * LINE);
+    CHECK(heightOf("#>#>aaaaaaaaa", 50) == 3 * LINE);
+
+    // #< takes it away again, and can't go below zero
+    CHECK(heightOf("#>#<aaaaaaaaaa", 50) == 2 * LINE);
+    CHECK(heightOf("#<#<aaaaaaaaaa", 50) == 2 * LINE);
+
+    // #2 indents the wrapped lines to the second tab stop, 10 + 50 after #~,
+    // leaving room for one character on each of them
+    CHECK(heightOf("#>#~aaaaaaa", 70) == LINE);
+    CHECK(heightOf("#>#~aaaaaaaaaa", 70) == 2 * LINE);
+    CHECK(heightOf("#>#~#2aaaaaaaaaa", 70) == 4 * LINE);
+}
+
+static void testTabs(void) {
+    // Default tab stops are every 28 points
+    CHECK(heightOf("aa#tb", 50) == LINE);
+    CHECK(heightOf("aaaa#tb", 50) == 2 * LINE);
+
+    // With #> the tab stops are the indent, the second tab stop, then every
+    // indent, so moving the second stop out with #~ pushes b past the edge
+    CHECK(heightOf("#>aa#tb", 65) == LINE);
+    CHECK(heightOf("#>#~aa#tb", 65) == 2 * LINE);
+    CHECK(heightOf("#>#~aa#tb", 70) == LINE);
+}
+
+static void testAttachments(void) {
+    CHECK(heightOf("aa#Sstar ", 50) == LINE);
+    CHECK(heightOf("aaa#Sstar ", 50) == 2 * LINE);
+    CHECK(heightOf("aaa#Sstar #Fimage.png ", 50) == 2 * LINE);
+    CHECK(heightOf("#Sa #Sb #Sc ", 50) == 2 * LINE);
+
+    // Attachments are as tall as the font they are in
+    CHECK(heightOf("a#]#Sstar ", 1000) == 16);
+}
+
+// Every character is only measured once for each font, including ones
+// outside ASCII.
+static void testCaching(void) {
+    static const uint16_t text[] = {0x00E9, 0x4E2D, 0x6587, 0x00E9, 0x4E2D, 0x6587, 'a', 0xFFFD};
+    size_t len = sizeof(text) / sizeof(text[0]);
+
+    advanceCalls = 0;
+    CHECK(heightOf16(text, len, 1000) == LINE);
+    CHECK(advanceCalls == 5);
+
+    advanceCalls = 0;
+    CHECK(heightOf16(text, len, 1000) == LINE);
+    CHECK(heightOf16(text, len, 10) == 8 * LINE);
+    CHECK(advanceCalls == 0);
+}
+
+int main(void) {
+    MarkupMetrics metrics = {NULL, stubAdvance, stubLineHeight, stubAttachmentWidth};
+
+    cache = MarkupMetricsCacheCreate(&metrics);
+    CHECK(cache != NULL);
+
+    if (cache != NULL) {
+        // Caching first, before anything else has been measured
+        testCaching();
+        testLines();
+        testNewLines();
+        testIndents();
+        testTabs();
+        testAttachments();
+    }
+
+    MarkupMetricsCacheFree(cache);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,209 @@
+//
+//  TestMarkupRuns.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "MarkupRuns.h"
+#include "TestCommon.h"
+#include <string.h>
+
+#define POINT_SIZE 12.0
+#define MAX_CHUNKS 16
+#define MAX_MARKUP 2048
+
+// Pieces of markup that random strings are made from - every escape, escapes
+// with arguments, the ones that add text and some that are not escapes at all
+static const char *pieces[] = {
+    "#b", "#i", "#-", "#+", "#(", "#)", "#[", "#]", "#0", "#O", "#G", "#A", "#K", "#R", "#B",
+    "#C", "#Y", "#N", "#M", "#W", "#D", "#!", "#U", "#E", "#>", "#<", "#2", "#~", "#.", "#|",
+    "#T", "#X", "#P", "#h", "##", "#t", "#n", "#z", "# ", "#L", "#S", "#F", "#",
+    "#Lhttp://x%20y ", "#Sa ", "#Fb ", "#Sstar.fill ",
+    " ", " ", " ", "  ", "a", "word", "Stop 8989",
+};
+
+#define PIECES (sizeof(pieces) / sizeof(pieces[0]))
+
+static bool sameState(const MarkupState *a, const MarkupState *b) {
+    return a->pointSize == b->pointSize && a->indent == b->indent && a->tabStop == b->tabStop &&
+           a->linkStart == b->linkStart && a->linkLength == b->linkLength &&
+           a->color == b->color && a->style == b->style && a->bold == b->bold &&
+           a->italic == b->italic && a->fixed == b->fixed && a->center == b->center &&
+           a->indentToTab == b->indentToTab;
+}
+
+static bool sameRun(const MarkupRun *a, const MarkupRun *b) {
+    return a->start == b->start && a->length == b->length && a->suffix == b->suffix &&
+           a->kind == b->kind && sameState(&a->state, &b->state);
+}
+
+static size_t randomMarkup(uint64_t *seed, uint16_t *chars, size_t max) {
+    size_t len = 0;
+    size_t count = testRandomBelow(seed, 200);
+
+    for (size_t p = 0; p < count; p++) {
+        if (testRandomBelow(seed, 20) == 0) {
+            // Something outside ASCII
+            if (len < max) {
+                chars[len++] = (uint16_t)(0x80 + testRandomBelow(seed, 0xFF00));
+            }
+            continue;
+        }
+
+        const char *piece = pieces[testRandomBelow(seed, PIECES)];
+
+        for (const char *c = piece; *c != 0 && len < max; c++) {
+            chars[len++] = (uint8_t)*c;
+        }
+    }
+
+    return len;
+}
+
+// Tokenizes in chunks as the parallel path does and checks it gives the same
+// runs and the same state at each bound as tokenizing it all in one go.
+static bool chunkedMatches(const uint16_t *chars, size_t len, size_t maxChunks) {
+    size_t bounds[MAX_CHUNKS + 1];
+    MarkupSummary summaries[MAX_CHUNKS];
+    MarkupRunList whole;
+    MarkupRunList joined;
+    bool ok = true;
+
+    MarkupRunListInit(&whole);
+    MarkupRunListInit(&joined);
+
+    size_t chunks = MarkupSplitChunks(chars, len, maxChunks, bounds);
+
+    ok = chunks >= 1 && chunks <= maxChunks && bounds[0] == 0 && bounds[chunks] == len;
+
+    for (size_t k = 1; ok && k < chunks; k++) {
+        // Each split is after a space and at an escape that does not add text
+        size_t p = bounds[k];
+
+        ok = p > bounds[k - 1] && p + 1 < len && chars[p - 1] == ' ' && chars[p] == '#' &&
+             chars[p + 1] != 'h' && chars[p + 1] != '#' && chars[p + 1] != 't' &&
+             chars[p + 1] != 'n';
+    }
+
+    for (size_t k = 0; k < chunks; k++) {
+        MarkupSummaryInit(&summaries[k]);
+        ok = ok && MarkupSummarize(chars, len, bounds[k], bounds[k + 1], &summaries[k]);
+    }
+
+    ok = ok && MarkupTokenize(chars, len, POINT_SIZE, &whole);
+
+    MarkupState scanned;
+    MarkupState sequential;
+
+    MarkupStateInit(&scanned, POINT_SIZE);
+    MarkupStateInit(&sequential, POINT_SIZE);
+
+    for (size_t k = 0; ok && k < chunks; k++) {
+        MarkupState state = scanned;
+        MarkupRunList ignored;
+
+        // The state from the summaries matches tokenizing up to the bound
+        if (k > 0) {
+            MarkupRunListInit(&ignored);
+            ok = MarkupTokenizeRange(chars,
+                                     len,
+                                     bounds[k - 1],
+                                     bounds[k],
+                                     POINT_SIZE,
+                                     &sequential,
+                                     &ignored) &&
+                 sameState(&state, &sequential);
+            MarkupRunListFree(&ignored);
+        }
+
+        ok = ok && MarkupTokenizeRange(
+                       chars, len, bounds[k], bounds[k + 1], POINT_SIZE, &state, &joined);
+
+        MarkupSummaryApply(&summaries[k], &scanned, POINT_SIZE);
+    }
+
+    ok = ok && joined.count == whole.count;
+
+    for (size_t i = 0; ok && i < whole.count; i++) {
+        ok = sameRun(&joined.runs[i], &whole.runs[i]);
+    }
+
+    for (size_t k = 0; k < chunks; k++) {
+        MarkupSummaryFree(&summaries[k]);
+    }
+
+    MarkupRunListFree(&whole);
+    MarkupRunListFree(&joined);
+    return ok;
+}
+
+static size_t fromAscii(const char *markup, uint16_t *chars) {
+    size_t len = strlen(markup);
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)markup[i];
+    }
+
+    return len;
+}
+
+static void testSplits(void) {
+    uint16_t chars[MAX_MARKUP];
+    size_t bounds[MAX_CHUNKS + 1];
+    size_t len = 0;
+
+    // Nowhere to split
+    len = fromAscii("no escapes at all", chars);
+    CHECK(MarkupSplitChunks(chars, len, 4, bounds) == 1 && bounds[1] == len);
+    CHECK(MarkupSplitChunks(chars, 0, 4, bounds) == 1 && bounds[0] == 0 && bounds[1] == 0);
+
+    // Escapes that add text, or with no space before, are not split at
+    len = fromAscii("aaaa #n bbbb #t cccc ## dddd#b eeee #", chars);
+    CHECK(MarkupSplitChunks(chars, len, 4, bounds) == 1);
+
+    // Splits at the first place it can after each third
+    len = fromAscii("aaaa #b bbbb #i cccc #b", chars);
+    CHECK(MarkupSplitChunks(chars, len, 3, bounds) == 3 && bounds[1] == 13 && bounds[2] == 21);
+
+    // Bold from the first chunk carries into the second
+    CHECK(chunkedMatches(chars, len, 3));
+}
+
+static void testRandomMarkup(void) {
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    uint16_t chars[MAX_MARKUP];
+    size_t mismatches = 0;
+
+    for (int n = 0; n < 20000; n++) {
+        size_t len = randomMarkup(&seed, chars, MAX_MARKUP);
+
+        for (size_t maxChunks = 1; maxChunks <= MAX_CHUNKS; maxChunks++) {
+            if (!chunkedMatches(chars, len, maxChunks)) {
+                mismatches++;
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+int main(void) {
+    testSplits();
+    testRandomMarkup();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,65 @@
+//
+//  TestModeAwarePalette.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "ModeAwarePalette.h"
+#include "TestCommon.h"
+
+static void testPalette(void) {
+    // The colors modeAwareBlue and modeAwareGrayText always had
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceLight, ModeAwareColorBlue) == 0x0066FFFF);
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceDark, ModeAwareColorBlue) == 0x0099FFFF);
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceLight, ModeAwareColorGrayText) == 0x808080FF);
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceDark, ModeAwareColorGrayText) == 0xAAAAAAFF);
+
+    // Every color is either in the table for both appearances or uses labelColor
+    for (int c = ModeAwareColorNone + 1; c < ModeAwareColorCount; c++) {
+        for (int a = 0; a < ModeAwareAppearanceCount; a++) {
+            uint32_t rgba = ModeAwarePaletteRGBA((ModeAwareAppearance)a, (ModeAwareColor)c);
+
+            CHECK(ModeAwarePaletteUsesLabelColor((ModeAwareColor)c) == (rgba == 0));
+        }
+    }
+
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceLight, ModeAwareColorNone) == 0);
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceCount, ModeAwareColorBlue) == 0);
+    CHECK(ModeAwarePaletteRGBA(ModeAwareAppearanceLight, ModeAwareColorCount) == 0);
+    CHECK(ModeAwarePaletteRGBA((ModeAwareAppearance)-1, ModeAwareColorBlue) == 0);
+}
+
+static void testMarkup(void) {
+    CHECK(ModeAwareColorForMarkup('D') == ModeAwareColorText);
+    CHECK(ModeAwareColorForMarkup('!') == ModeAwareColorAlert);
+    CHECK(ModeAwareColorForMarkup('U') == ModeAwareColorBlue);
+    CHECK(ModeAwareColorForMarkup('K') == ModeAwareColorGrayText);
+
+    // Fixed colors and everything else
+    for (int c = 0; c < 0x10000; c++) {
+        if (c != 'D' && c != '!' && c != 'U' && c != 'K') {
+            CHECK(ModeAwareColorForMarkup((uint16_t)c) == ModeAwareColorNone);
+        }
+    }
+}
+
+int main(void) {
+    testPalette();
+    testMarkup();
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,222 @@
+//
+//  TestPercentEncoding.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "PercentEncoding.h"
+#include "TestCommon.h"
+#include <string.h>
+
+#define ALNUM "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+#define URL_PATH_EXTRA "!$&'()*+,-./:=@_~"
+
+static const PercentEncodeSet sets[] = {PercentEncodeUrlPath, PercentEncodeAlphanumeric};
+
+static bool referenceSafe(uint8_t c, PercentEncodeSet set) {
+    if (c == 0) {
+        return false;
+    }
+    if (strchr(ALNUM, c) != NULL) {
+        return true;
+    }
+    return set == PercentEncodeUrlPath && strchr(URL_PATH_EXTRA, c) != NULL;
+}
+
+static bool encodesTo(const char *src, size_t len, PercentEncodeSet set, const char *expected) {
+    PercentBuffer buf;
+    bool ok = false;
+
+    PercentBufferInit(&buf, NULL, 0);
+
+    if (PercentEncodeAppend(&buf, (const uint8_t *)src, len, set)) {
+        ok = buf.length == strlen(expected) &&
+             (buf.length == 0 || memcmp(buf.bytes, expected, buf.length) == 0);
+    }
+
+    PercentBufferFree(&buf);
+    return ok;
+}
+
+static bool decodesTo(const char *src, const char *expected, size_t expectedLen) {
+    PercentBuffer buf;
+    bool ok = false;
+
+    PercentBufferInit(&buf, NULL, 0);
+
+    if (PercentDecodeAppend(&buf, (const uint8_t *)src, strlen(src))) {
+        ok = buf.length == expectedLen &&
+             (expectedLen == 0 || memcmp(buf.bytes, expected, expectedLen) == 0);
+    }
+
+    PercentBufferFree(&buf);
+    return ok;
+}
+
+// A bad decode must leave what was already in the buffer alone
+static bool rejectsDecode(const char *src) {
+    char storage[8];
+    PercentBuffer buf;
+    bool ok = false;
+
+    PercentBufferInit(&buf, storage, sizeof(storage));
+
+    if (PercentBufferAppend(&buf, "xy", 2) &&
+        !PercentDecodeAppend(&buf, (const uint8_t *)src, strlen(src))) {
+        ok = buf.length == 2 && memcmp(buf.bytes, "xy", 2) == 0;
+    }
+
+    PercentBufferFree(&buf);
+    return ok;
+}
+
+// The table must match the character sets byte for byte
+static void testTables(void) {
+    for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+        for (int i = 0; i < 256; i++) {
+            uint8_t c = (uint8_t)i;
+            bool safe = PercentEncodeSafePrefix(&c, 1, sets[s]) == 1;
+            char expected[4];
+
+            CHECK(safe == referenceSafe(c, sets[s]));
+
+            if (safe) {
+                snprintf(expected, sizeof(expected), "%c", c);
+            } else {
+                snprintf(expected, sizeof(expected), "%%%02X", c);
+            }
+
+            CHECK(encodesTo((const char *)&c, 1, sets[s], expected));
+        }
+    }
+}
+
+static void testExamples(void) {
+    CHECK(encodesTo("a b/c", 5, PercentEncodeUrlPath, "a%20b/c"));
+    CHECK(encodesTo("a b/c", 5, PercentEncodeAlphanumeric, "a%20b%2Fc"));
+    CHECK(encodesTo("caf\xC3\xA9", 5, PercentEncodeAlphanumeric, "caf%C3%A9"));
+    CHECK(encodesTo("", 0, PercentEncodeAlphanumeric, ""));
+
+    // Embedded NUL is encoded and does not end the input
+    CHECK(encodesTo("a\0b", 3, PercentEncodeAlphanumeric, "a%00b"));
+    CHECK(encodesTo("a\0b", 3, PercentEncodeUrlPath, "a%00b"));
+    CHECK(PercentEncodeSafePrefix((const uint8_t *)"a\0b", 3, PercentEncodeAlphanumeric) == 1);
+    CHECK(PercentAsciiPrefix((const uint8_t *)"a\0b", 3) == 3);
+
+    CHECK(decodesTo("a%20b", "a b", 3));
+    CHECK(decodesTo("%c3%A9", "\xC3\xA9", 2));
+    CHECK(decodesTo("a%00b", "a\0b", 3));
+    CHECK(decodesTo("no escapes", "no escapes", 10));
+    CHECK(decodesTo("%25%2525", "%%25", 4));
+
+    // Malformed % sequences, including at the end of the input
+    CHECK(rejectsDecode("%"));
+    CHECK(rejectsDecode("abc%"));
+    CHECK(rejectsDecode("abc%4"));
+    CHECK(rejectsDecode("%G0"));
+    CHECK(rejectsDecode("%0G"));
+    CHECK(rejectsDecode("%%41"));
+    CHECK(rejectsDecode("ok%20then%2"));
+}
+
+static void testAsciiPrefix(void) {
+    uint8_t bytes[48];
+
+    // A high byte at every position, from every alignment
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= 40; len++) {
+            for (size_t high = 0; high <= len; high++) {
+                memset(bytes, 'a', sizeof(bytes));
+
+                if (high < len) {
+                    bytes[offset + high] = (uint8_t)(0x80 | high);
+                }
+
+                CHECK(PercentAsciiPrefix(bytes + offset, len) == high);
+            }
+        }
+    }
+}
+
+// Encode then decode gives back the bytes, for random bytes including NULs,
+// UTF-8 and invalid UTF-8.
+static void testRoundTrip(void) {
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    uint8_t src[300];
+    char storage[16];
+
+    for (int n = 0; n < 20000; n++) {
+        size_t len = testRandomBelow(&seed, sizeof(src) + 1);
+        uint32_t kind = testRandomBelow(&seed, 3);
+
+        for (size_t i = 0; i < len; i++) {
+            switch (kind) {
+            case 0: // Any byte
+                src[i] = (uint8_t)testRandom(&seed);
+                break;
+            case 1: // Mostly safe with a few others
+                src[i] = testRandomBelow(&seed, 8) == 0
+                             ? (uint8_t)testRandom(&seed)
+                             : (uint8_t)ALNUM[testRandomBelow(&seed, sizeof(ALNUM) - 1)];
+                break;
+            default: // ASCII only, so lots of punctuation and control characters
+                src[i] = (uint8_t)testRandomBelow(&seed, 0x80);
+                break;
+            }
+        }
+
+        for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+            PercentBuffer encoded;
+            PercentBuffer decoded;
+
+            // A small buffer so growing off the stack is covered too
+            PercentBufferInit(&encoded, storage, sizeof(storage));
+            PercentBufferInit(&decoded, NULL, 0);
+
+            size_t safe = PercentEncodeSafePrefix(src, len, sets[s]);
+            size_t expectedSafe = 0;
+
+            while (expectedSafe < len && referenceSafe(src[expectedSafe], sets[s])) {
+                expectedSafe++;
+            }
+
+            CHECK(safe == expectedSafe);
+            CHECK(PercentEncodeAppend(&encoded, src, len, sets[s]));
+            CHECK(encoded.length >= len && encoded.length <= len * 3);
+
+            for (size_t i = 0; i < encoded.length; i++) {
+                uint8_t c = (uint8_t)encoded.bytes[i];
+                CHECK(c == '%' || referenceSafe(c, sets[s]));
+            }
+
+            CHECK(PercentDecodeAppend(&decoded, (const uint8_t *)encoded.bytes, encoded.length));
+            CHECK(decoded.length == len && (len == 0 || memcmp(decoded.bytes, src, len) == 0));
+
+            PercentBufferFree(&encoded);
+            PercentBufferFree(&decoded);
+        }
+    }
+}
+
+int main(void) {
+    testTables();
+    testExamples();
+    testAsciiPrefix();
+    testRoundTrip();
+
+    return TEST_RESULT();
+}
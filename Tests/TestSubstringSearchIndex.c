@@ -0,0 +1,292 @@
+//
+//  TestSubstringSearchIndex.c
+//
+//  Created by Andy Wallace on 10/18/26.
+//
+
+// Copyright 2026 Andrew Wallace
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "SubstringIndex.h"
+#include "TestCommon.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_STRINGS 400
+#define MAX_CHARS (MAX_STRINGS * 24)
+#define MAX_SEARCH 8
+
+// The strings for an index, back to back as SubstringIndexCreate takes them
+typedef struct {
+    uint16_t chars[MAX_CHARS];
+    size_t offsets[MAX_STRINGS + 1];
+    size_t count;
+} Strings;
+
+static void addString(Strings *strings, const uint16_t *chars, size_t len) {
+    size_t start = strings->offsets[strings->count];
+
+    memcpy(strings->chars + start, chars, len * sizeof(uint16_t));
+    strings->count++;
+    strings->offsets[strings->count] = start + len;
+}
+
+static size_t fromAscii(const char *str, uint16_t *chars) {
+    size_t len = strlen(str);
+
+    for (size_t i = 0; i < len; i++) {
+        chars[i] = (uint8_t)str[i];
+    }
+
+    return len;
+}
+
+static void addAscii(Strings *strings, const char *str) {
+    uint16_t chars[64];
+    addString(strings, chars, fromAscii(str, chars));
+}
+
+static bool bruteContains(const Strings *strings, size_t i, const uint16_t *search, size_t len) {
+    const uint16_t *hay = strings->chars + strings->offsets[i];
+    size_t hayLen = strings->offsets[i + 1] - strings->offsets[i];
+
+    for (size_t start = 0; len > 0 && start + len <= hayLen; start++) {
+        if (memcmp(hay + start, search, len * sizeof(uint16_t)) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static size_t bruteSearch(const Strings *strings,
+                          const uint16_t *search,
+                          size_t len,
+                          uint32_t *matches) {
+    size_t found = 0;
+
+    for (size_t i = 0; i < strings->count; i++) {
+        if (bruteContains(strings, i, search, len)) {
+            matches[found++] = (uint32_t)i;
+        }
+    }
+
+    return found;
+}
+
+// The fewest strings that contain any one trigram of the search
+static size_t bruteCandidates(const Strings *strings, const uint16_t *search, size_t len) {
+    uint32_t matches[MAX_STRINGS];
+    size_t fewest = strings->count;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i + 3 <= len; i++) {
+        size_t found = bruteSearch(strings, search + i, 3, matches);
+
+        if (found < fewest) {
+            fewest = found;
+        }
+    }
+
+    return fewest;
+}
+
+// Checks the search against a brute force scan, with and without narrowing
+// from the searches one character shorter at either end.
+static bool searchMatches(const SubstringIndex *index,
+                          const Strings *strings,
+                          const uint16_t *search,
+                          size_t len) {
+    uint32_t expected[MAX_STRINGS];
+    uint32_t matches[MAX_STRINGS];
+    uint32_t previous[MAX_STRINGS];
+    size_t expectedCount = bruteSearch(strings, search, len, expected);
+    size_t count = SubstringIndexSearch(index, search, len, NULL, 0, matches);
+    bool ok = count == expectedCount &&
+              memcmp(matches, expected, count * sizeof(uint32_t)) == 0 &&
+              SubstringIndexCandidateCount(index, search, len) ==
+                  bruteCandidates(strings, search, len);
+
+    if (len > 1) {
+        for (size_t skip = 0; skip < 2; skip++) {
+            size_t previousCount =
+                SubstringIndexSearch(index, search + skip, len - 1, NULL, 0, previous);
+
+            count = SubstringIndexSearch(index, search, len, previous, previousCount, matches);
+            ok = ok && count == expectedCount &&
+                 memcmp(matches, expected, count * sizeof(uint32_t)) == 0;
+        }
+    }
+
+    return ok;
+}
+
+static bool asciiMatches(const SubstringIndex *index, const Strings *strings, const char *str) {
+    uint16_t search[64];
+    return searchMatches(index, strings, search, fromAscii(str, search));
+}
+
+static size_t asciiSearch(const SubstringIndex *index, const char *str, uint32_t *matches) {
+    uint16_t search[64];
+    return SubstringIndexSearch(index, search, fromAscii(str, search), NULL, 0, matches);
+}
+
+static void testBasics(void) {
+    static Strings strings;
+    uint32_t matches[MAX_STRINGS];
+
+    addAscii(&strings, "main st & 5th ave");
+    addAscii(&strings, "mainmainmain");
+    addAscii(&strings, "aaaa");
+    addAscii(&strings, "");
+    addAscii(&strings, "ab");
+    addAscii(&strings, "5th & main");
+
+    SubstringIndex *index = SubstringIndexCreate(strings.chars, strings.offsets, strings.count);
+    CHECK(index != NULL);
+
+    if (index == NULL) {
+        return;
+    }
+
+    CHECK(SubstringIndexCount(index) == 6);
+
+    // An empty search matches nothing, as with hasCaseInsensitiveSubstring:
+    CHECK(asciiSearch(index, "", matches) == 0);
+    CHECK(SubstringIndexCandidateCount(index, NULL, 0) == 0);
+
+    CHECK(asciiSearch(index, "main", matches) == 3 && matches[0] == 0 && matches[1] == 1 &&
+          matches[2] == 5);
+    CHECK(asciiSearch(index, "ab", matches) == 1 && matches[0] == 4);
+    CHECK(asciiSearch(index, "a", matches) == 5);
+    CHECK(asciiSearch(index, "aaaa", matches) == 1 && matches[0] == 2);
+    CHECK(asciiSearch(index, "aaaaa", matches) == 0);
+    CHECK(asciiSearch(index, "xyz", matches) == 0);
+
+    // Repeated trigrams only count a string once, and the rarest one is used
+    uint16_t search[64];
+    CHECK(SubstringIndexCandidateCount(index, search, fromAscii("mainmain", search)) == 1);
+    CHECK(SubstringIndexCandidateCount(index, search, fromAscii("aaa", search)) == 1);
+    CHECK(SubstringIndexCandidateCount(index, search, fromAscii("5th", search)) == 2);
+    CHECK(SubstringIndexCandidateCount(index, search, fromAscii("ma", search)) == 6);
+    CHECK(SubstringIndexCandidateCount(index, search, fromAscii("zzz", search)) == 0);
+
+    CHECK(asciiMatches(index, &strings, "main st"));
+    CHECK(asciiMatches(index, &strings, "5th & main"));
+    CHECK(asciiMatches(index, &strings, "in"));
+
+    // A previous result past the end of the index is ignored
+    uint32_t previous[] = {1, 7};
+    CHECK(SubstringIndexSearch(index, search, fromAscii("main", search), previous, 2, matches) ==
+              1 &&
+          matches[0] == 1);
+
+    SubstringIndexFree(index);
+}
+
+static void testEmpty(void) {
+    size_t offsets[1] = {0};
+    uint16_t search[64];
+    uint32_t matches[1];
+    SubstringIndex *index = SubstringIndexCreate(NULL, offsets, 0);
+
+    CHECK(index != NULL);
+
+    if (index != NULL) {
+        CHECK(SubstringIndexCount(index) == 0);
+        CHECK(SubstringIndexSearch(index, search, fromAscii("a", search), NULL, 0, matches) == 0);
+        CHECK(SubstringIndexSearch(index, search, fromAscii("abc", search), NULL, 0, matches) ==
+              0);
+    }
+
+    SubstringIndexFree(index);
+}
+
+// Random strings from a small alphabet, so there are lots of matches and
+// repeated trigrams, with some characters outside ASCII.
+static uint16_t randomChar(uint64_t *seed) {
+    static const uint16_t alphabet[] = {'a', 'b', 'c', ' ', 0x00E9, 0x4E2D, 0xFFFD};
+    return alphabet[testRandomBelow(seed, sizeof(alphabet) / sizeof(alphabet[0]))];
+}
+
+static void testRandomStrings(void) {
+    static Strings strings;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    size_t mismatches = 0;
+
+    for (int n = 0; n < 200; n++) {
+        strings.count = 0;
+        strings.offsets[0] = 0;
+
+        size_t count = testRandomBelow(&seed, MAX_STRINGS);
+
+        for (size_t i = 0; i < count; i++) {
+            uint16_t chars[24];
+            size_t len = testRandomBelow(&seed, 24);
+
+            for (size_t c = 0; c < len; c++) {
+                chars[c] = randomChar(&seed);
+            }
+
+            addString(&strings, chars, len);
+        }
+
+        SubstringIndex *index =
+            SubstringIndexCreate(strings.chars, strings.offsets, strings.count);
+        CHECK(index != NULL);
+
+        if (index == NULL) {
+            continue;
+        }
+
+        for (int q = 0; q < 50; q++) {
+            uint16_t search[MAX_SEARCH];
+            size_t len = 1 + testRandomBelow(&seed, MAX_SEARCH);
+
+            // Half of the searches are taken from a string so they match
+            size_t from = count > 0 ? testRandomBelow(&seed, (uint32_t)count) : 0;
+            size_t fromLen = count > 0 ? strings.offsets[from + 1] - strings.offsets[from] : 0;
+
+            if (testRandomBelow(&seed, 2) == 0 && fromLen >= len) {
+                size_t start = testRandomBelow(&seed, (uint32_t)(fromLen - len + 1));
+                memcpy(search,
+                       strings.chars + strings.offsets[from] + start,
+                       len * sizeof(uint16_t));
+            } else {
+                for (size_t c = 0; c < len; c++) {
+                    search[c] = randomChar(&seed);
+                }
+            }
+
+            if (!searchMatches(index, &strings, search, len)) {
+                mismatches++;
+            }
+        }
+
+        SubstringIndexFree(index);
+    }
+
+    CHECK(mismatches == 0);
+}
+
+int main(void) {
+    testBasics();
+    testEmpty();
+    testRandomStrings();
+
+    return TEST_RESULT();
+}
@@ -18,18 +18,33 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#import "ModeAwarePalette.h"
 #import <UIKit/UIKit.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
+// Posted (on the main thread) by modeAwareAppearanceChanged when the
+// appearance has actually changed.
+extern NSNotificationName const ModeAwareAppearanceChangedNotification;
+
 @interface UIColor (DarkMode)
 
 + (UIColor *)modeAwareText;
 + (UIColor *)modeAwareBlue;
 + (UIColor *)modeAwareGrayText;
++ (UIColor *)modeAwareColor:(ModeAwareColor)color;
 + (UIColor *)randomColor;
 
+// Until modeAwareAppearanceChanged is first called the appearance is read from
+// the screen every time, as before. Calling it caches the appearance and posts
+// ModeAwareAppearanceChangedNotification when it changes.
+//
+// Breaking change: once an app has called modeAwareAppearanceChanged, darkMode,
+// modeAwareBlue and modeAwareGrayText keep returning the cached appearance
+// until it is called again. Apps that call it must do so from
+// traitCollectionDidChange: (on the main thread) on every change.
 + (bool)darkMode;
++ (void)modeAwareAppearanceChanged;
 
 @end
 
@@ -20,17 +20,61 @@
 
 #import "UIColor+DarkMode.h"
 #import "UIColor+HTML.h"
+#import <stdatomic.h>
 
-@implementation UIColor (DarkMode)
+NSNotificationName const ModeAwareAppearanceChangedNotification =
+    @"ModeAwareAppearanceChangedNotification";
 
-+ (bool)darkMode {
+// -1 until the app first calls modeAwareAppearanceChanged. Until then the
+// screen is asked every time, as it always was, so apps that never call it
+// still follow the appearance.
+static atomic_int cachedAppearance = -1;
+
+static ModeAwareAppearance screenAppearance(void) {
 #if TARGET_OS_WATCH
-    return false;
+    return ModeAwareAppearanceLight;
 #else
-    return ([UIScreen mainScreen].traitCollection.userInterfaceStyle == UIUserInterfaceStyleDark);
+    return ([UIScreen mainScreen].traitCollection.userInterfaceStyle == UIUserInterfaceStyleDark)
+               ? ModeAwareAppearanceDark
+               : ModeAwareAppearanceLight;
 #endif // TARGET_OS_WATCH
 }
 
+static ModeAwareAppearance currentAppearance(void) {
+    int appearance = atomic_load_explicit(&cachedAppearance, memory_order_relaxed);
+
+    if (appearance < 0) {
+        return screenAppearance();
+    }
+
+    return (ModeAwareAppearance)appearance;
+}
+
+@implementation UIColor (DarkMode)
+
++ (bool)darkMode {
+    return currentAppearance() == ModeAwareAppearanceDark;
+}
+
++ (void)modeAwareAppearanceChanged {
+    int appearance = screenAppearance();
+    int previous = atomic_exchange(&cachedAppearance, appearance);
+
+    if (previous != appearance) {
+        [[NSNotificationCenter defaultCenter]
+            postNotificationName:ModeAwareAppearanceChangedNotification
+                          object:nil];
+    }
+}
+
++ (UIColor *)modeAwareColor:(ModeAwareColor)color {
+    if (ModeAwarePaletteUsesLabelColor(color)) {
+        return [UIColor modeAwareText];
+    }
+
+    return [UIColor colorWithRGBA:ModeAwarePaletteRGBA(currentAppearance(), color)];
+}
+
 + (UIColor *)modeAwareText {
 #if TARGET_OS_WATCH
     return [UIColor blackColor];
@@ -40,18 +84,11 @@
 }
 
 + (UIColor *)modeAwareBlue {
-    if (self.darkMode) {
-        // These colors are based in the "information icon" (i) color
-        return [UIColor colorWithHTMLColor:0x0099FF];
-    }
-    return [UIColor colorWithHTMLColor:0x0066FF];
+    return [UIColor modeAwareColor:ModeAwareColorBlue];
 }
 
 + (UIColor *)modeAwareGrayText {
-    if (self.darkMode) {
-        return [UIColor lightGrayColor];
-    }
-    return [UIColor grayColor];
+    return [UIColor modeAwareColor:ModeAwareColorGrayText];
 }
 
 + (UIColor *)randomColor {
@@ -31,6 +31,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (UIColor *)colorWithHTMLColor:(uint32_t)col;
 
+/// Returns a cached color for a packed 0xRRGGBBAA value.
++ (UIColor *)colorWithRGBA:(uint32_t)rgba;
+
 /// Returns the HTML hex string representation of the color (e.g., "#FF5733").
 - (NSString *)hexString;
 
@@ -18,26 +18,74 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#import "TaskDispatch.h"
+#import "HexColor.h"
 #import "UIColor+HTML.h"
+#import <stdatomic.h>
+
+// The colors are kept in a small direct mapped cache. A reader takes the entry
+// out of its slot while it looks at it, so another thread can never free it
+// from under it, and then puts it back. If two threads want the same slot at
+// once one of them just misses and makes a new color.
+#define COLOR_CACHE_SLOTS 256
+#define COLOR_CACHE_SLOT(RGBA) (((RGBA) * 2654435761u) >> 24)
+#define HEX_STACK_CHARS 32
+
+typedef struct {
+    uint32_t rgba;
+    CFTypeRef color;
+} ColorCacheEntry;
+
+static _Atomic(ColorCacheEntry *) colorCache[COLOR_CACHE_SLOTS];
+
+static void freeColorCacheEntry(ColorCacheEntry *entry) {
+    if (entry != NULL) {
+        CFRelease(entry->color);
+        free(entry);
+    }
+}
+
+// Extended range components can be below 0 or above 1, so clamp them first
+static inline uint32_t componentByte(CGFloat component) {
+    return (uint32_t)lround(fmin(fmax(component, 0.0), 1.0) * 255.0);
+}
 
 @implementation UIColor (HTML)
 
 + (UIColor *)colorWithHTMLColor:(uint32_t)col {
-    static NSCache<NSNumber *, UIColor *> *colorCache;
+    return [UIColor colorWithRGBA:HEX_COLOR_OPAQUE(col & 0xFFFFFF)];
+}
+
++ (UIColor *)colorWithRGBA:(uint32_t)rgba {
+    _Atomic(ColorCacheEntry *) *slot = &colorCache[COLOR_CACHE_SLOT(rgba)];
+    ColorCacheEntry *entry = atomic_exchange(slot, NULL);
+    UIColor *color = nil;
+
+    if (entry != NULL) {
+        if (entry->rgba == rgba) {
+            color = (__bridge UIColor *)entry->color;
+        }
 
-    DO_ONCE(^{
-      colorCache = [NSCache new];
-    });
+        // Put it back unless someone else has already filled the slot
+        ColorCacheEntry *empty = NULL;
 
-    UIColor *color = [colorCache objectForKey:@(col)];
+        if (!atomic_compare_exchange_strong(slot, &empty, entry)) {
+            freeColorCacheEntry(entry);
+        }
+    }
 
     if (color == nil) {
-        color = [UIColor colorWithRed:COL_HTML_R(col)
-                                green:COL_HTML_G(col)
-                                 blue:COL_HTML_B(col)
-                                alpha:1.0];
-        [colorCache setObject:color forKey:@(col)];
+        color = [UIColor colorWithRed:COL_HTML_R(rgba >> 8)
+                                green:COL_HTML_G(rgba >> 8)
+                                 blue:COL_HTML_B(rgba >> 8)
+                                alpha:((CGFloat)(rgba & 0xFF)) / 255.0];
+
+        entry = malloc(sizeof(ColorCacheEntry));
+
+        if (entry != NULL) {
+            entry->rgba = rgba;
+            entry->color = CFBridgingRetain(color);
+            freeColorCacheEntry(atomic_exchange(slot, entry));
+        }
     }
 
     return color;
@@ -48,11 +96,14 @@
 
     // Try to extract RGBA components
     if ([self getRed:&red green:&green blue:&blue alpha:&alpha]) {
-        int r = (int)(red * 255);
-        int g = (int)(green * 255);
-        int b = (int)(blue * 255);
-        int a = (int)(alpha * 255);
-        return [NSString stringWithFormat:@"#%02X%02X%02X%02X", r, g, b, a];
+        uint32_t r = componentByte(red);
+        uint32_t g = componentByte(green);
+        uint32_t b = componentByte(blue);
+        uint32_t a = componentByte(alpha);
+        char hex[HEX_COLOR_MAX_CHARS];
+        size_t len = HexColorFormat((r << 24) | (g << 16) | (b << 8) | a, hex);
+
+        return [[NSString alloc] initWithBytes:hex length:len encoding:NSASCIIStringEncoding];
     }
     return @"#000000";
 }
@@ -61,42 +112,33 @@
     if (hexString == nil) {
         return nil;
     }
-    // Trim whitespace and newlines, and uppercase the string
-    NSMutableString *cleanString = [[hexString
-        stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]]
-        mutableCopy];
-    [cleanString setString:[cleanString uppercaseString]];
-
-    // Remove '#' prefix if present
-    if ([cleanString hasPrefix:@"#"]) {
-        [cleanString deleteCharactersInRange:NSMakeRange(0, 1)];
-    }
 
-    // The string should be exactly 6 characters for valid RGB
-    // or 8 if it includes the alpha channel.
-    if ([cleanString length] != 6 && [cleanString length] != 8) {
-        return nil;
+    uint32_t rgba = 0;
+    NSUInteger len = hexString.length;
+    bool valid = false;
+
+    // Colors are short so usually fit on the stack
+    if (len <= HEX_STACK_CHARS) {
+        unichar chars[HEX_STACK_CHARS];
+        [hexString getCharacters:chars range:NSMakeRange(0, len)];
+        valid = HexColorParseUTF16(chars, len, &rgba);
+    } else {
+        unichar *chars = malloc(len * sizeof(unichar));
+
+        if (chars == NULL) {
+            return nil;
+        }
+
+        [hexString getCharacters:chars range:NSMakeRange(0, len)];
+        valid = HexColorParseUTF16(chars, len, &rgba);
+        free(chars);
     }
 
-    // Scan the hex value
-    unsigned long long rgbValue = 0;
-    NSScanner *scanner = [NSScanner scannerWithString:cleanString];
-    if (![scanner scanHexLongLong:&rgbValue]) {
+    if (!valid) {
         return nil;
     }
 
-    CGFloat alpha = 1.0;
-
-    if ([cleanString length] == 8) {
-        alpha = (rgbValue & 0x000000FF) / 255.0;
-        rgbValue = rgbValue >> 8;
-    }
-
-    CGFloat red = ((rgbValue & 0xFF0000) >> 16) / 255.0;
-    CGFloat green = ((rgbValue & 0x00FF00) >> 8) / 255.0;
-    CGFloat blue = (rgbValue & 0x0000FF) / 255.0;
-
-    return [UIColor colorWithRed:red green:green blue:blue alpha:alpha];
+    return [UIColor colorWithRGBA:rgba];
 }
 
 @end